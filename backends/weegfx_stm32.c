@@ -5,7 +5,7 @@
 
 // -- "Inspired" by https://vivonomicon.com/2019/07/05/bare-metal-stm32-programming-part-9-dma-megamix/ --
 
-/// Maximum number of bytes that can be sent at once over DMA.
+/// Maximum number of items (bytes, or 16-bit halfwords with 16-bit SPI frames) that can be sent at once over DMA.
 #define DMA_MAX_TRANSFER_SIZE 0xFFFF
 
 int wgfxSTM32Init(WGFXstm32Backend *self, unsigned priority)
@@ -14,6 +14,10 @@ int wgfxSTM32Init(WGFXstm32Backend *self, unsigned priority)
     {
         return 0;
     }
+    if((self->flags & WGFX_STM32_SPI_16BIT) && self->bpp % 2 != 0)
+    {
+        return 0;
+    }
     if(priority > 0x3)
     {
         priority = 0x3;
@@ -23,6 +27,11 @@ int wgfxSTM32Init(WGFXstm32Backend *self, unsigned priority)
     const unsigned dmaSize = (self->spi->CR1 & SPI_CR1_DFF) ? 0x1 : 0x0; // Either 16 or 8 bits
     self->dmaChannel->CCR = 0x00000000;
     self->dmaChannel->CCR |= (priority << DMA_CCR_PL_Pos) | (dmaSize << DMA_CCR_MSIZE_Pos) | (dmaSize << DMA_CCR_PSIZE_Pos) | DMA_CCR_MINC | DMA_CCR_DIR;
+    if(self->flags & WGFX_STM32_DMA_IRQ)
+    {
+        // Interrupt on transfer complete / transfer error
+        self->dmaChannel->CCR |= DMA_CCR_TCIE | DMA_CCR_TEIE;
+    }
 
     // Destination = the SPI data register
     self->dmaChannel->CPAR = (WGFX_U32)&self->spi->DR;
@@ -30,21 +39,56 @@ int wgfxSTM32Init(WGFXstm32Backend *self, unsigned priority)
     // Clear pending transfer complete/error bits
     self->dma->IFCR |= self->dmaISRDoneMask;
 
+    self->xferBuf = 0;
+    self->xferSize = 0;
+    self->pendingBuf = 0;
+    self->pendingSize = 0;
+    self->xferBusy = 0;
+
     return 1;
 }
 
+/// Returns the size in bytes of the items the DMA channel is currently configured to transfer (1 or 2).
+WGFX_FORCEINLINE static unsigned dmaItemSize(const WGFXstm32Backend *self)
+{
+    return (self->dmaChannel->CCR & DMA_CCR_MSIZE) ? 2 : 1;
+}
+
 /// Setup the DMA channel to transfer a buffer to SPI and enable it.
-WGFX_FORCEINLINE void dmaSpiTx(WGFXstm32Backend *self, const void *buf, WGFX_SIZET size)
+/// `memIncrement` is either `DMA_CCR_MINC` (to send `size` items from `buf`) or 0 (to send `*buf` `size` times).
+WGFX_FORCEINLINE static void dmaSpiTx(WGFXstm32Backend *self, const void *buf, WGFX_SIZET size, WGFX_U32 memIncrement)
 {
+    // (the DMA channel is disabled here, so CCR can be modified)
+    self->dmaChannel->CCR = (self->dmaChannel->CCR & ~DMA_CCR_MINC) | memIncrement;
     self->dmaChannel->CNDTR = size;
     self->dmaChannel->CMAR = (WGFX_U32)buf;
     // Start the DMA channel
     self->dmaChannel->CCR |= DMA_CCR_EN;
 }
 
-/// Spinlock waiting for a DMA transfer to complete / error out, then clear ISR flags and disable the DMA channel.
-WGFX_FORCEINLINE void dmaWait(WGFXstm32Backend *self)
+/// Waits for a DMA transfer to complete / error out, then clear ISR flags and disable the DMA channel.
+/// In `WGFX_STM32_DMA_IRQ` mode, waits for all chained transfers to complete instead (the IRQ handler does the rest).
+WGFX_FORCEINLINE static void dmaWait(WGFXstm32Backend *self)
 {
+    if(self->flags & WGFX_STM32_DMA_IRQ)
+    {
+        while(self->xferBusy)
+        {
+            if(self->flags & WGFX_STM32_DMA_WFI)
+            {
+                // (WFI wakes up on a pending interrupt even with interrupts disabled; this way the DMA interrupt
+                // can not fire between checking `xferBusy` and going to sleep, which could sleep forever)
+                __disable_irq();
+                if(self->xferBusy)
+                {
+                    __WFI();
+                }
+                __enable_irq();
+            }
+        }
+        return;
+    }
+
     // Until the DMA channel is disabled or a transfer complete event / transfer error event happens...
     while((self->dmaChannel->CCR & DMA_CCR_EN) && !(self->dma->ISR & self->dmaISRDoneMask)) {}
     // Clear interrupt flags
@@ -53,26 +97,142 @@ WGFX_FORCEINLINE void dmaWait(WGFXstm32Backend *self)
     self->dmaChannel->CCR &= ~DMA_CCR_EN;
 }
 
-void wgfxSTM32Write(const WGFX_U8 *buf, WGFX_SIZET size, void *userPtr)
+/// Sends `size` items from `buf` (or `*buf`, `size` times if `memIncrement` is 0; see `dmaSpiTx()`) to SPI,
+/// in as many DMA transfers as needed. Does NOT wait for the last transfer to complete.
+static void dmaSpiTxChained(WGFXstm32Backend *self, const WGFX_U8 *buf, WGFX_SIZET size, WGFX_U32 memIncrement)
 {
-    WGFXstm32Backend *self = (WGFXstm32Backend *)userPtr;
+    const WGFX_SIZET step = memIncrement ? DMA_MAX_TRANSFER_SIZE * dmaItemSize(self) : 0;
 
-    WGFX_SIZET i;
-    for(i = DMA_MAX_TRANSFER_SIZE; i < size; i += DMA_MAX_TRANSFER_SIZE)
+    if(self->flags & WGFX_STM32_DMA_IRQ)
     {
         dmaWait(self);
-        dmaSpiTx(self, buf, DMA_MAX_TRANSFER_SIZE);
+        if(size == 0)
+        {
+            return;
+        }
+
+        // Start the first transfer; the IRQ handler chains the rest
+        const WGFX_SIZET xferSize = (size > DMA_MAX_TRANSFER_SIZE) ? DMA_MAX_TRANSFER_SIZE : size;
+        self->pendingBuf = buf + step;
+        self->pendingSize = size - xferSize;
+        self->pendingMemIncrement = memIncrement;
+        self->xferBusy = 1;
+        dmaSpiTx(self, buf, xferSize, memIncrement);
+        return;
     }
-    i -= DMA_MAX_TRANSFER_SIZE;
-    if((size - i) > 0)
+
+    while(size > 0)
     {
+        const WGFX_SIZET xferSize = (size > DMA_MAX_TRANSFER_SIZE) ? DMA_MAX_TRANSFER_SIZE : size;
         dmaWait(self);
-        dmaSpiTx(self, buf, size - i);
+        dmaSpiTx(self, buf, xferSize, memIncrement);
+        buf += step;
+        size -= xferSize;
+    }
+}
+
+void wgfxSTM32DmaIRQHandler(WGFXstm32Backend *self)
+{
+    if(!(self->dma->ISR & self->dmaISRDoneMask))
+    {
+        return; // (e.g. a half-transfer interrupt)
+    }
+    self->dma->IFCR |= self->dmaISRGlobalMask;
+    self->dmaChannel->CCR &= ~DMA_CCR_EN;
+
+    const WGFX_SIZET size = self->pendingSize;
+    if(size > 0)
+    {
+        const WGFX_SIZET xferSize = (size > DMA_MAX_TRANSFER_SIZE) ? DMA_MAX_TRANSFER_SIZE : size;
+        const WGFX_U8 *buf = self->pendingBuf;
+        self->pendingBuf = buf + (self->pendingMemIncrement ? DMA_MAX_TRANSFER_SIZE * dmaItemSize(self) : 0);
+        self->pendingSize = size - xferSize;
+        dmaSpiTx(self, buf, xferSize, self->pendingMemIncrement);
+        return;
     }
 
+    self->xferBusy = 0;
+    if(self->transferDone)
+    {
+        self->transferDone(self->backendUserPtr);
+    }
+}
+
+void wgfxSTM32Write(const WGFX_U8 *buf, WGFX_SIZET size, void *userPtr)
+{
+    WGFXstm32Backend *self = (WGFXstm32Backend *)userPtr;
+
+    self->xferBuf = buf;
+    self->xferSize = size;
+    dmaSpiTxChained(self, buf, size / dmaItemSize(self), DMA_CCR_MINC); // (the DMA counts items, not bytes)
+
     // NOTE: Does NOT wait for the last DMA transfer to complete!
     //       This way the CPU can perform more useful operations in the meantime
-    //       (until the next `wgfxSTM32Write()` happens, at which point the first `dmaWait()` spinlocks!)
+    //       (until the next `wgfxSTM32Write()` happens, at which point the first `dmaWait()` spinlocks - or sleeps,
+    //       in `WGFX_STM32_DMA_IRQ` mode)
+}
+
+int wgfxSTM32WriteRepeat(const WGFX_U8 *pixel, WGFX_SIZET count, void *userPtr)
+{
+    WGFXstm32Backend *self = (WGFXstm32Backend *)userPtr;
+
+    // The DMA can only send the same item over and over; check that the pixel is made of copies of one item
+    const unsigned itemSize = dmaItemSize(self);
+    if(self->bpp % itemSize != 0)
+    {
+        return 0;
+    }
+    for(unsigned i = itemSize; i < self->bpp; i++)
+    {
+        if(pixel[i] != pixel[i - itemSize])
+        {
+            return 0;
+        }
+    }
+
+    dmaWait(self); // (`repeatItem` could still be in use by a previous repeated write)
+    self->repeatItem = (itemSize == 2) ? (WGFX_U16)(pixel[0] | (pixel[1] << 8)) : pixel[0]; // (little-endian, like `buf` in `wgfxSTM32Write()`)
+    self->xferSize = 0; // (the DMA is not going to read from any pixel buffer)
+
+    dmaSpiTxChained(self, (const WGFX_U8 *)&self->repeatItem, count * (self->bpp / itemSize), 0);
+    // NOTE: Like `wgfxSTM32Write()`, does NOT wait for the last DMA transfer to complete!
+    return 1;
+}
+
+void wgfxSTM32WaitWrite(const WGFX_U8 *buf, void *userPtr)
+{
+    WGFXstm32Backend *self = (WGFXstm32Backend *)userPtr;
+    // (`wgfxSTM32Write()` always waits for the previous transfer to complete before starting the next one, so at most
+    // one buffer - `xferBuf` - can be in flight; it may be from anywhere inside the region `buf` stands for)
+    if(self->xferSize > 0
+       && (!self->screen || wgfxWaitWriteOverlaps(self->screen, buf, self->xferBuf, self->xferSize)))
+    {
+        dmaWait(self);
+        self->xferSize = 0;
+    }
+}
+
+/// Switches the SPI (and the DMA channel) to 16-bit frames if `sixteenBit`, to 8-bit frames otherwise.
+/// Waits for any ongoing transfer to complete first.
+static void setFrameSize(WGFXstm32Backend *self, int sixteenBit)
+{
+    dmaWait(self);
+    // `DFF` can only be changed while the SPI is disabled, and disabling it mid-frame would truncate the frame
+    while(!(self->spi->SR & SPI_SR_TXE)) {}
+    while(self->spi->SR & SPI_SR_BSY) {}
+
+    self->spi->CR1 &= ~SPI_CR1_SPE;
+    if(sixteenBit)
+    {
+        self->spi->CR1 |= SPI_CR1_DFF;
+        self->dmaChannel->CCR |= (0x1 << DMA_CCR_MSIZE_Pos) | (0x1 << DMA_CCR_PSIZE_Pos);
+    }
+    else
+    {
+        self->spi->CR1 &= ~SPI_CR1_DFF;
+        self->dmaChannel->CCR &= ~(DMA_CCR_MSIZE | DMA_CCR_PSIZE);
+    }
+    self->spi->CR1 |= SPI_CR1_SPE;
 }
 
 void wgfxSTM32BeginWrite(unsigned x, unsigned y, unsigned w, unsigned h, void *userPtr)
@@ -82,14 +242,23 @@ void wgfxSTM32BeginWrite(unsigned x, unsigned y, unsigned w, unsigned h, void *u
     {
         self->beginScreenWrite(x, y, w, h, self->backendUserPtr);
     }
+    if(self->flags & WGFX_STM32_SPI_16BIT)
+    {
+        setFrameSize(self, 1); // (commands are sent with 8-bit frames, pixel data with 16-bit ones)
+    }
 }
 
 void wgfxSTM32EndWrite(void *userPtr)
 {
     WGFXstm32Backend *self = (WGFXstm32Backend *)userPtr;
+    if(self->flags & WGFX_STM32_SPI_16BIT)
+    {
+        setFrameSize(self, 0); // (also waits for all writes to have reached the screen)
+    }
     if(self->endScreenWrite)
     {
         dmaWait(self); // Ensure that all writes have reached the screen
+        self->xferSize = 0;
         self->endScreenWrite(self->backendUserPtr);
     }
 }
@@ -33,6 +33,27 @@ typedef void (*WGFXstm32BeginScreenWritePFN)(unsigned x, unsigned y, unsigned w,
 /// Called after the pixel data is written to the screen.
 typedef void (*WGFXstm32EndScreenWritePFN)(void *backendUserPtr);
 
+/// Called (from the DMA interrupt handler!) when all pending DMA transfers have completed.
+typedef void (*WGFXstm32TransferDonePFN)(void *backendUserPtr);
+
+/// Flags that change how the STM32 backend waits for DMA transfers.
+typedef enum
+{
+    /// Use DMA interrupts instead of polling `ISR`: transfers bigger than what the DMA can send at once are
+    /// chained by `wgfxSTM32DmaIRQHandler()`, which must be called from the DMA channel's interrupt handler.
+    WGFX_STM32_DMA_IRQ = 0x1,
+
+    /// (`WGFX_STM32_DMA_IRQ` only) Sleep with WFI while waiting for transfers to complete, instead of spinning.
+    WGFX_STM32_DMA_WFI = 0x2,
+
+    /// Send pixel data with 16-bit SPI frames, and commands (`beginScreenWrite`/`endScreenWrite`) with 8-bit ones.
+    /// Halves the number of DMA items per pixel on 2 bytes-per-pixel screens (`bpp` must be even).
+    /// The SPI sends each 16-bit frame MSB first, so pixel data must be stored as native (little-endian) 16-bit
+    /// values instead of big-endian bytes - i.e. as `WGFX_U16` colors or `bitmapconv.py --format rgb565le` images.
+    /// The SPI should be configured for 8-bit frames when calling `wgfxSTM32Init()`.
+    WGFX_STM32_SPI_16BIT = 0x4,
+} WGFXstm32Flags;
+
 /// An instance of the STM32 backend for weegfx.
 typedef struct
 {
@@ -68,6 +89,33 @@ typedef struct
 
     /// User pointer, passed as-is to `beginScreenWrite` and `endScreenWrite`.
     void *backendUserPtr;
+
+    /// Backend-internal: the 8/16-bit item that is sent over and over by `wgfxSTM32WriteRepeat()`.
+    WGFX_U16 repeatItem;
+
+    /// The screen that draws through this backend, or null. Lets `wgfxSTM32WaitWrite()` only wait for the transfer in
+    /// flight if it is from the part of memory the library is about to reuse; if null, it always waits for it.
+    const WGFXscreen *screen;
+
+    /// Backend-internal: the buffer last passed to `wgfxSTM32Write()` whose DMA transfer could still be in flight,
+    /// and its size in bytes (0 if none).
+    const WGFX_U8 *xferBuf;
+    WGFX_SIZET xferSize;
+
+    /// A combination of `WGFXstm32Flags`. 0 = spin-wait on `dma`'s `ISR` (the default).
+    WGFX_U32 flags;
+
+    /// (`WGFX_STM32_DMA_IRQ` only) Called from `wgfxSTM32DmaIRQHandler()` when the last chained transfer completes,
+    /// i.e. when the DMA has finished reading from the buffer last passed to `write` or `writeRepeat`. Can be null.
+    WGFXstm32TransferDonePFN transferDone;
+
+    /// Backend-internal: the data still to be sent by chained DMA transfers (`WGFX_STM32_DMA_IRQ` only).
+    const WGFX_U8 *volatile pendingBuf;
+    volatile WGFX_SIZET pendingSize;
+    volatile WGFX_U32 pendingMemIncrement;
+
+    /// Backend-internal: true while a (chained) DMA transfer is in progress (`WGFX_STM32_DMA_IRQ` only).
+    volatile int xferBusy;
 } WGFXstm32Backend;
 
 /// Initializes the DMA channel at `self->dma` so that it will transfer data to
@@ -77,8 +125,14 @@ typedef struct
 ///
 /// Note that this does NOT enable the DMA, or try to change the configuration of the SPI!
 /// (don't forget to enable the peripherals, set `TXDMAEN` in the SPI's `CR2` and/or DMA remap bits in `SYSCFG`!)
+/// With `WGFX_STM32_DMA_IRQ`, this enables the DMA channel's transfer complete/error interrupts, but enabling
+/// the interrupt in the NVIC is up to the user.
 int wgfxSTM32Init(WGFXstm32Backend *self, unsigned priority);
 
+/// To be called from the interrupt handler of `self->dmaChannel` in `WGFX_STM32_DMA_IRQ` mode.
+/// Clears the DMA flags, then starts the next chained transfer or calls `transferDone` if there is none left.
+void wgfxSTM32DmaIRQHandler(WGFXstm32Backend *self);
+
 /// The `beginWrite` implementation for STM32.
 /// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32Backend`!
 void wgfxSTM32BeginWrite(unsigned x, unsigned y, unsigned w, unsigned h, void *userPtr);
@@ -87,6 +141,20 @@ void wgfxSTM32BeginWrite(unsigned x, unsigned y, unsigned w, unsigned h, void *u
 /// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32Backend`!
 void wgfxSTM32Write(const WGFX_U8 *buf, WGFX_SIZET size, void *userPtr);
 
+/// The `writeRepeat` implementation for STM32.
+/// Sends the same DMA item over and over (with memory increment disabled), so it can only repeat pixels
+/// that consist of a repeated 8-bit (16-bit if `SPI_CR1_DFF` or `WGFX_STM32_SPI_16BIT` is set) value - e.g. any 1bpp color, or any
+/// RGB565 color with 16-bit SPI frames; returns false for anything else.
+/// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32Backend`!
+int wgfxSTM32WriteRepeat(const WGFX_U8 *pixel, WGFX_SIZET count, void *userPtr);
+
+/// The `waitWrite` implementation for STM32.
+/// Only waits if the DMA is reading from the region `buf` stands for (the half of the scratch buffer it is in, with
+/// `WGFX_SCREEN_DOUBLE_BUFFER`; see `WGFXscreen::waitWrite`), so that the library can render to one half of the
+/// scratch buffer while the other is being transferred. Needs `self->screen` for that; waits for any transfer without.
+/// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32Backend`!
+void wgfxSTM32WaitWrite(const WGFX_U8 *buf, void *userPtr);
+
 /// The `endWrite` implementation for STM32.
 /// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32Backend`!
 void wgfxSTM32EndWrite(void *userPtr);
@@ -0,0 +1,286 @@
+// weegfx_stm32bus.c - weegfx backend for STM32 devices, driving several SPI displays that share one SPI and DMA channel
+// Copyright (c) 2019 Paolo Jovon <paolo.jovon@gmail.com>
+// Released under the 3-clause BSD license (see LICENSE)
+#include "weegfx_stm32bus.h"
+
+/// Returns the index of the queue entry after `index`.
+WGFX_FORCEINLINE static unsigned nextIndex(const WGFXstm32Bus *bus, unsigned index)
+{
+    return (index + 1 == bus->capacity) ? 0 : index + 1;
+}
+
+/// The `beginScreenWrite` of the bus' backend: forwards to the current display's.
+static void busBeginScreenWrite(unsigned x, unsigned y, unsigned w, unsigned h, void *backendUserPtr)
+{
+    const WGFXstm32BusScreen *display = ((WGFXstm32Bus *)backendUserPtr)->current;
+    display->beginScreenWrite(x, y, w, h, display->screenUserPtr);
+}
+
+/// The `endScreenWrite` of the bus' backend: forwards to the current display's.
+static void busEndScreenWrite(void *backendUserPtr)
+{
+    const WGFXstm32BusScreen *display = ((WGFXstm32Bus *)backendUserPtr)->current;
+    display->endScreenWrite(display->screenUserPtr);
+}
+
+/// Performs the queued operations of `bus` in order, until one of them starts a DMA transfer (the DMA interrupt
+/// handler then resumes from the next one) or the queue runs dry.
+/// Must be called with interrupts disabled, or from the DMA interrupt handler.
+static void runOps(WGFXstm32Bus *bus)
+{
+    WGFXstm32Backend *const backend = &bus->backend;
+    while(bus->head != bus->tail)
+    {
+        const WGFXstm32BusOp *op = &bus->ops[bus->head];
+        switch(op->type)
+        {
+        case WGFX_STM32_BUS_BEGIN:
+            bus->current = op->display;
+            backend->bpp = op->display->bpp;
+            wgfxSTM32BeginWrite(op->params.window.x, op->params.window.y, op->params.window.w, op->params.window.h,
+                                backend);
+            break;
+        case WGFX_STM32_BUS_WRITE:
+            bus->busyBuf = op->params.write.buf;
+            bus->busySize = op->params.write.size;
+            wgfxSTM32Write(op->params.write.buf, op->params.write.size, backend);
+            break;
+        case WGFX_STM32_BUS_REPEAT:
+            // (the pixel was checked to be repeatable when submitted, and `repeatItem` is a copy of it)
+            wgfxSTM32WriteRepeat(op->params.repeat.pixel, op->params.repeat.count, backend);
+            break;
+        case WGFX_STM32_BUS_END:
+            wgfxSTM32EndWrite(backend);
+            bus->current = 0;
+            break;
+        }
+        bus->head = nextIndex(bus, bus->head);
+
+        if(backend->xferBusy)
+        {
+            return; // (`busTransferDone()` carries on)
+        }
+        bus->busySize = 0;
+    }
+    bus->running = 0;
+}
+
+/// The `transferDone` of the bus' backend: the DMA is idle, move on to the next queued operations.
+static void busTransferDone(void *backendUserPtr)
+{
+    WGFXstm32Bus *bus = (WGFXstm32Bus *)backendUserPtr;
+    bus->busySize = 0;
+    runOps(bus);
+}
+
+/// A condition to wait on in `waitWhile()`.
+typedef int (*WGFXstm32BusWaitPFN)(const WGFXstm32Bus *bus, const void *arg);
+
+static int queueFull(const WGFXstm32Bus *bus, const void *arg)
+{
+    (void)arg;
+    return nextIndex(bus, bus->tail) == bus->head;
+}
+
+static int queueRunning(const WGFXstm32Bus *bus, const void *arg)
+{
+    (void)arg;
+    return bus->running;
+}
+
+/// What `wgfxSTM32BusWaitWrite()` waits for: the display and the `buf` passed to it.
+typedef struct
+{
+    const WGFXstm32BusScreen *display;
+    const WGFX_U8 *buf;
+} WGFXstm32BusWait;
+
+/// True if any queued write, or the one the DMA is reading from, overlaps the region that `waitWrite()` is waiting for
+/// (see `WGFXstm32BusWait` and `wgfxWaitWriteOverlaps()`).
+static int regionBusy(const WGFXstm32Bus *bus, const void *arg)
+{
+    const WGFXstm32BusWait *wait = (const WGFXstm32BusWait *)arg;
+    const WGFXscreen *screen = wait->display->screen;
+
+    // (the queue is checked first: the DMA interrupt sets `busyBuf` before dequeuing the write that reads from it)
+    for(unsigned i = bus->head; i != bus->tail; i = nextIndex(bus, i))
+    {
+        const WGFXstm32BusOp *op = &bus->ops[i];
+        if(op->type == WGFX_STM32_BUS_WRITE
+           && wgfxWaitWriteOverlaps(screen, wait->buf, op->params.write.buf, op->params.write.size))
+        {
+            return 1;
+        }
+    }
+    return wgfxWaitWriteOverlaps(screen, wait->buf, bus->busyBuf, bus->busySize);
+}
+
+/// Waits for DMA interrupts until `cond(bus, arg)` is false.
+static void waitWhile(const WGFXstm32Bus *bus, WGFXstm32BusWaitPFN cond, const void *arg)
+{
+    while(cond(bus, arg))
+    {
+        if(bus->backend.flags & WGFX_STM32_DMA_WFI)
+        {
+            // (see `dmaWait()` in weegfx_stm32.c)
+            __disable_irq();
+            if(cond(bus, arg))
+            {
+                __WFI();
+            }
+            __enable_irq();
+        }
+    }
+}
+
+/// Returns the next free entry of the queue for an operation of the given type, waiting for one if it is full.
+/// The entry is only queued by `submitOp()`.
+static WGFXstm32BusOp *allocOp(WGFXstm32BusScreen *display, WGFXstm32BusOpType type)
+{
+    WGFXstm32Bus *const bus = display->bus;
+    waitWhile(bus, queueFull, 0);
+
+    WGFXstm32BusOp *op = &bus->ops[bus->tail];
+    op->type = (WGFX_U8)type;
+    op->display = display;
+    return op;
+}
+
+/// Queues the entry last returned by `allocOp()`, and starts working through the queue if the bus is idle.
+static void submitOp(WGFXstm32Bus *bus)
+{
+    __disable_irq();
+    bus->tail = nextIndex(bus, bus->tail);
+    if(!bus->running)
+    {
+        bus->running = 1;
+        runOps(bus);
+    }
+    __enable_irq();
+}
+
+int wgfxSTM32BusInit(WGFXstm32Bus *bus, unsigned priority)
+{
+    if(!(bus && bus->ops && bus->capacity >= 2 && (bus->backend.flags & WGFX_STM32_DMA_IRQ)))
+    {
+        return 0;
+    }
+
+    WGFXstm32Backend *const backend = &bus->backend;
+    backend->bpp = 0; // (set to each display's in turn)
+    backend->beginScreenWrite = busBeginScreenWrite;
+    backend->endScreenWrite = busEndScreenWrite;
+    backend->backendUserPtr = bus;
+    backend->transferDone = busTransferDone;
+    backend->screen = 0; // (each `WGFXstm32BusScreen` has its own, and its own `waitWrite`)
+
+    bus->head = 0;
+    bus->tail = 0;
+    bus->running = 0;
+    bus->current = 0;
+    bus->busyBuf = 0;
+    bus->busySize = 0;
+
+    return wgfxSTM32Init(backend, priority);
+}
+
+int wgfxSTM32BusScreenInit(WGFXstm32BusScreen *display, WGFXstm32Bus *bus, const WGFXscreen *screen,
+                           WGFXstm32BeginScreenWritePFN beginScreenWrite, WGFXstm32EndScreenWritePFN endScreenWrite,
+                           void *screenUserPtr)
+{
+    if(!(display && bus && screen && screen->bpp > 0 && beginScreenWrite && endScreenWrite))
+    {
+        return 0;
+    }
+    if((bus->backend.flags & WGFX_STM32_SPI_16BIT) && screen->bpp % 2 != 0)
+    {
+        return 0;
+    }
+
+    display->bus = bus;
+    display->screen = screen;
+    display->bpp = screen->bpp;
+    display->beginScreenWrite = beginScreenWrite;
+    display->endScreenWrite = endScreenWrite;
+    display->screenUserPtr = screenUserPtr;
+    return 1;
+}
+
+void wgfxSTM32BusFlush(WGFXstm32Bus *bus)
+{
+    waitWhile(bus, queueRunning, 0);
+}
+
+void wgfxSTM32BusBeginWrite(unsigned x, unsigned y, unsigned w, unsigned h, void *userPtr)
+{
+    WGFXstm32BusScreen *display = (WGFXstm32BusScreen *)userPtr;
+
+    WGFXstm32BusOp *op = allocOp(display, WGFX_STM32_BUS_BEGIN);
+    op->params.window.x = (WGFX_U16)x;
+    op->params.window.y = (WGFX_U16)y;
+    op->params.window.w = (WGFX_U16)w;
+    op->params.window.h = (WGFX_U16)h;
+    submitOp(display->bus);
+}
+
+void wgfxSTM32BusWrite(const WGFX_U8 *buf, WGFX_SIZET size, void *userPtr)
+{
+    WGFXstm32BusScreen *display = (WGFXstm32BusScreen *)userPtr;
+    if(size == 0)
+    {
+        return;
+    }
+
+    WGFXstm32BusOp *op = allocOp(display, WGFX_STM32_BUS_WRITE);
+    op->params.write.buf = buf;
+    op->params.write.size = size;
+    submitOp(display->bus);
+}
+
+int wgfxSTM32BusWriteRepeat(const WGFX_U8 *pixel, WGFX_SIZET count, void *userPtr)
+{
+    WGFXstm32BusScreen *display = (WGFXstm32BusScreen *)userPtr;
+    const WGFXstm32Backend *backend = &display->bus->backend;
+
+    // Same check as `wgfxSTM32WriteRepeat()`, that will only run later: with the item size pixel data is sent with
+    const unsigned itemSize = ((backend->flags & WGFX_STM32_SPI_16BIT) || (backend->spi->CR1 & SPI_CR1_DFF)) ? 2 : 1;
+    if(display->bpp > sizeof(((WGFXstm32BusOp *)0)->params.repeat.pixel) || display->bpp % itemSize != 0)
+    {
+        return 0;
+    }
+    for(unsigned i = itemSize; i < display->bpp; i++)
+    {
+        if(pixel[i] != pixel[i - itemSize])
+        {
+            return 0;
+        }
+    }
+    if(count == 0)
+    {
+        return 1;
+    }
+
+    WGFXstm32BusOp *op = allocOp(display, WGFX_STM32_BUS_REPEAT);
+    for(unsigned i = 0; i < display->bpp; i++)
+    {
+        op->params.repeat.pixel[i] = pixel[i];
+    }
+    op->params.repeat.count = count;
+    submitOp(display->bus);
+    return 1;
+}
+
+void wgfxSTM32BusWaitWrite(const WGFX_U8 *buf, void *userPtr)
+{
+    const WGFXstm32BusScreen *display = (const WGFXstm32BusScreen *)userPtr;
+    const WGFXstm32BusWait wait = {display, buf};
+    waitWhile(display->bus, regionBusy, &wait);
+}
+
+void wgfxSTM32BusEndWrite(void *userPtr)
+{
+    WGFXstm32BusScreen *display = (WGFXstm32BusScreen *)userPtr;
+
+    allocOp(display, WGFX_STM32_BUS_END);
+    submitOp(display->bus);
+}
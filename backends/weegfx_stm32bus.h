@@ -0,0 +1,174 @@
+// weegfx_stm32bus.h - weegfx backend for STM32 devices, driving several SPI displays that share one SPI and DMA channel
+// Copyright (c) 2019 Paolo Jovon <paolo.jovon@gmail.com>
+// Released under the 3-clause BSD license (see LICENSE)
+//
+// Each display gets its own `WGFXscreen` and `WGFXstm32BusScreen` (with its own CS line and address window
+// callbacks), and all of them submit their writes to a single `WGFXstm32Bus`. Writes are queued instead of being
+// performed right away: the DMA interrupt handler works through the queue, switching between displays as needed,
+// so that the bus is kept busy while the CPU renders the next chunk for any of the displays.
+#ifndef WEEGFX_STM32BUS_H
+#define WEEGFX_STM32BUS_H
+
+#include "weegfx_stm32.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct WGFXstm32Bus;
+struct WGFXstm32BusScreen;
+
+/// The type of a queued `WGFXstm32BusOp`.
+typedef enum
+{
+    /// Select a screen (assert its CS) and set its address window: `beginScreenWrite`.
+    WGFX_STM32_BUS_BEGIN = 0,
+    /// Send pixel data from a buffer: `write`.
+    WGFX_STM32_BUS_WRITE,
+    /// Send the same pixel over and over: `writeRepeat`.
+    WGFX_STM32_BUS_REPEAT,
+    /// Deselect the screen (deassert its CS): `endScreenWrite`.
+    WGFX_STM32_BUS_END,
+} WGFXstm32BusOpType;
+
+/// A write operation queued on a `WGFXstm32Bus`.
+typedef struct
+{
+    /// A `WGFXstm32BusOpType`.
+    WGFX_U8 type;
+
+    /// The display the operation was submitted by.
+    struct WGFXstm32BusScreen *display;
+
+    /// Operation-specific parameters, depending on `type`.
+    union
+    {
+        struct
+        {
+            WGFX_U16 x, y, w, h;
+        } window;
+
+        struct
+        {
+            const WGFX_U8 *buf; ///< Must stay valid until the data is sent (see `wgfxSTM32BusWaitWrite()`).
+            WGFX_SIZET size;
+        } write;
+
+        struct
+        {
+            WGFX_U8 pixel[4]; ///< (a copy)
+            WGFX_SIZET count;
+        } repeat;
+    } params;
+} WGFXstm32BusOp;
+
+/// A set of displays on the same SPI, with separate CS lines, sharing the DMA channel of `backend`.
+typedef struct WGFXstm32Bus
+{
+    /// The backend that owns the SPI and DMA channel. Populate it as per `wgfxSTM32Init()`, except for:
+    /// - `flags`, that must contain `WGFX_STM32_DMA_IRQ` (the queue is worked through by the DMA interrupt handler);
+    /// - `bpp`, `beginScreenWrite`, `endScreenWrite`, `backendUserPtr`, `transferDone` and `screen`, that are set by
+    ///   `wgfxSTM32BusInit()` (each `WGFXstm32BusScreen` has its own).
+    ///
+    /// Call `wgfxSTM32DmaIRQHandler(&bus->backend)` from the DMA channel's interrupt handler.
+    WGFXstm32Backend backend;
+
+    /// The queue of write operations; `capacity` is its size (at least 2; one entry is always kept free).
+    /// A few entries per screen are enough to keep the bus busy: each `write` of a chunk of scratch buffer takes one,
+    /// plus two for the address window around it.
+    WGFXstm32BusOp *ops;
+    unsigned capacity;
+
+    /// Backend-internal: the indices of the first queued operation and of the first free entry of `ops` (the queue
+    /// wraps around); `head` is advanced as operations are performed, `tail` as they are submitted.
+    volatile unsigned head, tail;
+
+    /// Backend-internal: true while the queue is being worked through (i.e. until it runs dry).
+    volatile int running;
+
+    /// Backend-internal: the screen whose CS is asserted, if any.
+    struct WGFXstm32BusScreen *current;
+
+    /// Backend-internal: the buffer the DMA is reading from, and its size in bytes (0 if none).
+    const WGFX_U8 *volatile busyBuf;
+    volatile WGFX_SIZET busySize;
+} WGFXstm32Bus;
+
+/// A display on a `WGFXstm32Bus`. Set the `userPtr` of its `WGFXscreen` to point to it.
+///
+/// Note that in order to overlap rendering and transfers, the `WGFXscreen` should use `WGFX_SCREEN_DOUBLE_BUFFER`
+/// and the `waitWrite` below; each display needs its own scratch buffer.
+/// Drawing functions return before their pixel data is sent: bitmaps drawn from RAM must not be modified until
+/// then (see `wgfxSTM32BusFlush()`).
+typedef struct WGFXstm32BusScreen
+{
+    /// The bus the display is on.
+    WGFXstm32Bus *bus;
+
+    /// The weegfx screen for the display (whose scratch buffer `waitWrite` protects).
+    const WGFXscreen *screen;
+
+    /// The bytes per pixel to transfer (`screen->bpp`; must be even with `WGFX_STM32_SPI_16BIT`).
+    unsigned bpp;
+
+    /// Called (from the DMA interrupt handler, or with interrupts disabled!) before pixel data for the given rect is
+    /// sent to the display.
+    ///
+    /// Use this to assert the display's CS pin and set its address window.
+    WGFXstm32BeginScreenWritePFN beginScreenWrite;
+
+    /// Called (from the DMA interrupt handler, or with interrupts disabled!) after the pixel data has been sent to
+    /// the display.
+    ///
+    /// Use this to deassert the display's CS pin.
+    WGFXstm32EndScreenWritePFN endScreenWrite;
+
+    /// User pointer, passed as-is to `beginScreenWrite` and `endScreenWrite`.
+    void *screenUserPtr;
+} WGFXstm32BusScreen;
+
+/// Sets up the bus and initializes its backend (see `WGFXstm32Bus::backend` and `wgfxSTM32Init()`).
+/// `priority` is the priority to set for the DMA channel (0 to 3).
+/// Returns false on error.
+int wgfxSTM32BusInit(WGFXstm32Bus *bus, unsigned priority);
+
+/// Sets up `display` as the display on `bus` that `screen` draws to, with the given callbacks
+/// (see `WGFXstm32BusScreen`). `screen`'s `bpp` and scratch buffer must already be set.
+/// Returns false on error.
+int wgfxSTM32BusScreenInit(WGFXstm32BusScreen *display, WGFXstm32Bus *bus, const WGFXscreen *screen,
+                           WGFXstm32BeginScreenWritePFN beginScreenWrite, WGFXstm32EndScreenWritePFN endScreenWrite,
+                           void *screenUserPtr);
+
+/// Waits until every queued operation on `bus` has completed (and all displays are deselected).
+void wgfxSTM32BusFlush(WGFXstm32Bus *bus);
+
+/// The `beginWrite` implementation for a display on a bus. Queues the address window; returns immediately.
+/// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32BusScreen`!
+void wgfxSTM32BusBeginWrite(unsigned x, unsigned y, unsigned w, unsigned h, void *userPtr);
+
+/// The `write` implementation for a display on a bus. Queues the transfer of `buf`; returns immediately, unless
+/// the queue is full.
+/// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32BusScreen`!
+void wgfxSTM32BusWrite(const WGFX_U8 *buf, WGFX_SIZET size, void *userPtr);
+
+/// The `writeRepeat` implementation for a display on a bus. Like `wgfxSTM32WriteRepeat()`, can only repeat pixels
+/// that consist of a repeated DMA item (and of at most 4 bytes); returns false for anything else.
+/// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32BusScreen`!
+int wgfxSTM32BusWriteRepeat(const WGFX_U8 *pixel, WGFX_SIZET count, void *userPtr);
+
+/// The `waitWrite` implementation for a display on a bus.
+/// Waits until no queued write, nor the one the DMA is reading from, is from the part of memory the library is
+/// about to reuse: the half (or the whole, if not `WGFX_SCREEN_DOUBLE_BUFFER`) of the scratch buffer `buf` is in,
+/// or `buf` onwards for any other buffer.
+/// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32BusScreen`!
+void wgfxSTM32BusWaitWrite(const WGFX_U8 *buf, void *userPtr);
+
+/// The `endWrite` implementation for a display on a bus. Queues the end of the address window; returns immediately.
+/// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32BusScreen`!
+void wgfxSTM32BusEndWrite(void *userPtr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEEGFX_STM32BUS_H
@@ -0,0 +1,159 @@
+// weegfx_stm32fsmc.c - weegfx backend for STM32 devices, driving parallel (8080) displays via the FSMC/FMC
+// Copyright (c) 2019 Paolo Jovon <paolo.jovon@gmail.com>
+// Released under the 3-clause BSD license (see LICENSE)
+#include "weegfx_stm32fsmc.h"
+
+/// Maximum number of items (bytes, or halfwords with a 16-bit bus) that can be sent at once over DMA.
+#define DMA_MAX_TRANSFER_SIZE 0xFFFF
+
+int wgfxSTM32FSMCInit(WGFXstm32fsmcBackend *self, unsigned priority)
+{
+    if(!(self && self->dataAddr && self->dma && self->dmaChannel))
+    {
+        return 0;
+    }
+    if(!(self->busWidth == 8 || self->busWidth == 16) || self->bpp % (self->busWidth / 8) != 0)
+    {
+        return 0;
+    }
+    if(priority > 0x3)
+    {
+        priority = 0x3;
+    }
+
+    // 8/16-bit memory size, 8/16-bit "peripheral" (FSMC) size, increment memory pointer but not the FSMC address,
+    // memory -> "peripheral", memory-to-memory (so that the DMA does not wait for peripheral requests)
+    const unsigned dmaSize = (self->busWidth == 16) ? 0x1 : 0x0;
+    self->dmaChannel->CCR = 0x00000000;
+    self->dmaChannel->CCR |= (priority << DMA_CCR_PL_Pos) | (dmaSize << DMA_CCR_MSIZE_Pos) | (dmaSize << DMA_CCR_PSIZE_Pos)
+                             | DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_MEM2MEM;
+
+    // Destination = the FSMC data address
+    self->dmaChannel->CPAR = (WGFX_U32)self->dataAddr;
+
+    // Clear pending transfer complete/error bits
+    self->dma->IFCR |= self->dmaISRDoneMask;
+
+    self->xferBuf = 0;
+    self->xferSize = 0;
+
+    return 1;
+}
+
+/// Setup the DMA channel to transfer a buffer to the FSMC and enable it.
+/// `memIncrement` is either `DMA_CCR_MINC` (to send `size` items from `buf`) or 0 (to send `*buf` `size` times).
+WGFX_FORCEINLINE static void dmaFsmcTx(WGFXstm32fsmcBackend *self, const void *buf, WGFX_SIZET size, WGFX_U32 memIncrement)
+{
+    // (the DMA channel is disabled here, so CCR can be modified)
+    self->dmaChannel->CCR = (self->dmaChannel->CCR & ~DMA_CCR_MINC) | memIncrement;
+    self->dmaChannel->CNDTR = size;
+    self->dmaChannel->CMAR = (WGFX_U32)buf;
+    // Start the DMA channel
+    self->dmaChannel->CCR |= DMA_CCR_EN;
+}
+
+/// Spinlock waiting for a DMA transfer to complete / error out, then clear ISR flags and disable the DMA channel.
+WGFX_FORCEINLINE static void dmaWait(WGFXstm32fsmcBackend *self)
+{
+    // Until the DMA channel is disabled or a transfer complete event / transfer error event happens...
+    while((self->dmaChannel->CCR & DMA_CCR_EN) && !(self->dma->ISR & self->dmaISRDoneMask)) {}
+    // Clear interrupt flags
+    self->dma->IFCR |= self->dmaISRGlobalMask;
+    // Disable the DMA channel
+    self->dmaChannel->CCR &= ~DMA_CCR_EN;
+}
+
+/// Sends `size` items from `buf` (or `*buf`, `size` times if `memIncrement` is 0) to the FSMC,
+/// in as many DMA transfers as needed. Does NOT wait for the last transfer to complete.
+static void dmaFsmcTxChained(WGFXstm32fsmcBackend *self, const WGFX_U8 *buf, WGFX_SIZET size, WGFX_U32 memIncrement)
+{
+    const WGFX_SIZET step = memIncrement ? DMA_MAX_TRANSFER_SIZE * (self->busWidth / 8) : 0;
+    while(size > 0)
+    {
+        const WGFX_SIZET xferSize = (size > DMA_MAX_TRANSFER_SIZE) ? DMA_MAX_TRANSFER_SIZE : size;
+        dmaWait(self);
+        dmaFsmcTx(self, buf, xferSize, memIncrement);
+        buf += step;
+        size -= xferSize;
+    }
+}
+
+void wgfxSTM32FSMCCommand(WGFXstm32fsmcBackend *self, WGFX_U16 value, int isData)
+{
+    dmaWait(self); // (the DMA could still be writing pixel data to the bus)
+    volatile void *addr = isData ? self->dataAddr : self->cmdAddr;
+    if(self->busWidth == 16)
+    {
+        *(volatile WGFX_U16 *)addr = value;
+    }
+    else
+    {
+        *(volatile WGFX_U8 *)addr = (WGFX_U8)value;
+    }
+}
+
+void wgfxSTM32FSMCWrite(const WGFX_U8 *buf, WGFX_SIZET size, void *userPtr)
+{
+    WGFXstm32fsmcBackend *self = (WGFXstm32fsmcBackend *)userPtr;
+
+    self->xferBuf = buf;
+    self->xferSize = size;
+    dmaFsmcTxChained(self, buf, size / (self->busWidth / 8), DMA_CCR_MINC); // (the DMA counts items, not bytes)
+
+    // NOTE: Does NOT wait for the last DMA transfer to complete! (see `wgfxSTM32Write()`)
+}
+
+int wgfxSTM32FSMCWriteRepeat(const WGFX_U8 *pixel, WGFX_SIZET count, void *userPtr)
+{
+    WGFXstm32fsmcBackend *self = (WGFXstm32fsmcBackend *)userPtr;
+
+    // The DMA can only send the same item over and over; check that the pixel is made of copies of one item
+    const unsigned itemSize = self->busWidth / 8;
+    for(unsigned i = itemSize; i < self->bpp; i++)
+    {
+        if(pixel[i] != pixel[i - itemSize])
+        {
+            return 0;
+        }
+    }
+
+    dmaWait(self); // (`repeatItem` could still be in use by a previous repeated write)
+    self->repeatItem = (itemSize == 2) ? (WGFX_U16)(pixel[0] | (pixel[1] << 8)) : pixel[0]; // (little-endian, like `buf` in `wgfxSTM32FSMCWrite()`)
+    self->xferSize = 0; // (the DMA is not going to read from any pixel buffer)
+
+    dmaFsmcTxChained(self, (const WGFX_U8 *)&self->repeatItem, count * (self->bpp / itemSize), 0);
+    // NOTE: Like `wgfxSTM32FSMCWrite()`, does NOT wait for the last DMA transfer to complete!
+    return 1;
+}
+
+void wgfxSTM32FSMCWaitWrite(const WGFX_U8 *buf, void *userPtr)
+{
+    WGFXstm32fsmcBackend *self = (WGFXstm32fsmcBackend *)userPtr;
+    // (as in `wgfxSTM32WaitWrite()`, at most one buffer can be in flight)
+    if(self->xferSize > 0
+       && (!self->screen || wgfxWaitWriteOverlaps(self->screen, buf, self->xferBuf, self->xferSize)))
+    {
+        dmaWait(self);
+        self->xferSize = 0;
+    }
+}
+
+void wgfxSTM32FSMCBeginWrite(unsigned x, unsigned y, unsigned w, unsigned h, void *userPtr)
+{
+    WGFXstm32fsmcBackend *self = (WGFXstm32fsmcBackend *)userPtr;
+    if(self->beginScreenWrite)
+    {
+        self->beginScreenWrite(x, y, w, h, self->backendUserPtr);
+    }
+}
+
+void wgfxSTM32FSMCEndWrite(void *userPtr)
+{
+    WGFXstm32fsmcBackend *self = (WGFXstm32fsmcBackend *)userPtr;
+    dmaWait(self); // Ensure that all writes have reached the screen
+    self->xferSize = 0;
+    if(self->endScreenWrite)
+    {
+        self->endScreenWrite(self->backendUserPtr);
+    }
+}
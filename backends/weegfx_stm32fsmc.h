@@ -0,0 +1,126 @@
+// weegfx_stm32fsmc.h - weegfx backend for STM32 devices, driving parallel (8080) displays via the FSMC/FMC
+// Copyright (c) 2019 Paolo Jovon <paolo.jovon@gmail.com>
+// Released under the 3-clause BSD license (see LICENSE)
+#ifndef WEEGFX_STM32FSMC_H
+#define WEEGFX_STM32FSMC_H
+
+#ifndef WEEGFX_H
+#    include <weegfx.h>
+#endif
+
+#define WGFX_ANGLED(name) <name>
+
+#ifndef WGFX_STM32_DEVICE
+// WGFX_STM32_DEVICE: The name of the STM32CubeMX-generated header for the device, excluding the .h extension.
+// See `weegfx_stm32.h`.
+#    error "No WGFX_STM32_DEVICE defined!"
+#endif
+#include WGFX_ANGLED(WGFX_STM32_DEVICE.h)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Called before writing pixel data to the screen.
+typedef void (*WGFXstm32fsmcBeginScreenWritePFN)(unsigned x, unsigned y, unsigned w, unsigned h, void *backendUserPtr);
+
+/// Called after the pixel data is written to the screen.
+typedef void (*WGFXstm32fsmcEndScreenWritePFN)(void *backendUserPtr);
+
+/// An instance of the STM32 FSMC/FMC backend for weegfx.
+///
+/// The display is expected to be wired to a NOR/SRAM bank of the FSMC, with an address line driving its D/C
+/// (RS) pin; writing to the bank's address with that line high sends data, writing with it low sends commands.
+/// Pixel data is copied to the data address by memory-to-memory DMA.
+typedef struct
+{
+    /// The bytes per pixel to transfer.
+    unsigned bpp;
+
+    /// The width of the data bus in bits: either 8 or 16 (FSMC bank configured with `MWID` = 8 or 16 bits).
+    /// With a 16-bit bus each pixel is written as 16-bit values in native (little-endian) byte order, so pixel data
+    /// must be stored that way - i.e. as `WGFX_U16` colors or `bitmapconv.py --format rgb565le` images.
+    unsigned busWidth;
+
+    /// The FSMC address that writes pixel data to the display (D/C line high).
+    volatile void *dataAddr;
+
+    /// The FSMC address that writes commands to the display (D/C line low).
+    /// Not used by the backend itself; for `beginScreenWrite` and `endScreenWrite`, via `wgfxSTM32FSMCCommand()`.
+    volatile void *cmdAddr;
+
+    /// The DMA used to copy pixel data from memory to the FSMC.
+    DMA_TypeDef *dma;
+
+    /// The DMA channel in `dma` used to copy pixel data from memory to the FSMC.
+    DMA_Channel_TypeDef *dmaChannel;
+
+    /// `(1 << DMA_ISR_TCIFx_Pos) | (1 << DMA_ISR_TEIFx)` for x = index of `dmaChannel`;
+    /// ORed with `dma`'s `ISR` to know when a write is complete.
+    WGFX_U32 dmaISRDoneMask;
+
+    /// `DMA_ISR_TCIFx_GIF` for x = index of `dmaChannel`;
+    /// ORed with `dma`'s `ICFR` to clear DMA transfer flags.
+    WGFX_U32 dmaISRGlobalMask;
+
+    /// Called before pixel data for the given rect is written to the screen. Can be null.
+    ///
+    /// Use this to set the address window and prepare the screen for receiving data (e.g. ILI9341's `RAMWR`).
+    WGFXstm32fsmcBeginScreenWritePFN beginScreenWrite;
+
+    /// Called after pixel data has been written to the screen. Can be null.
+    WGFXstm32fsmcEndScreenWritePFN endScreenWrite;
+
+    /// User pointer, passed as-is to `beginScreenWrite` and `endScreenWrite`.
+    void *backendUserPtr;
+
+    /// Backend-internal: the 8/16-bit item that is sent over and over by `wgfxSTM32FSMCWriteRepeat()`.
+    WGFX_U16 repeatItem;
+
+    /// The screen that draws through this backend, or null (see `WGFXstm32Backend::screen`).
+    const WGFXscreen *screen;
+
+    /// Backend-internal: the buffer last passed to `wgfxSTM32FSMCWrite()` whose DMA transfer could still be in flight,
+    /// and its size in bytes (0 if none).
+    const WGFX_U8 *xferBuf;
+    WGFX_SIZET xferSize;
+} WGFXstm32fsmcBackend;
+
+/// Initializes the DMA channel at `self->dma` so that it will transfer data to `self->dataAddr`
+/// (this means that `self` should already have been populated by the user!)
+/// `priority` is the priority to set for the DMA channel (0 to 3).
+/// Returns false on error.
+///
+/// Note that this does NOT enable the DMA, or configure the FSMC and its GPIOs!
+int wgfxSTM32FSMCInit(WGFXstm32fsmcBackend *self, unsigned priority);
+
+/// Writes a command (`isData` = false) or a data item (`isData` = true) to the display, waiting for any pending
+/// pixel data DMA transfer to complete first. Meant to be used in `beginScreenWrite` and `endScreenWrite`.
+void wgfxSTM32FSMCCommand(WGFXstm32fsmcBackend *self, WGFX_U16 value, int isData);
+
+/// The `beginWrite` implementation for STM32 FSMC.
+/// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32fsmcBackend`!
+void wgfxSTM32FSMCBeginWrite(unsigned x, unsigned y, unsigned w, unsigned h, void *userPtr);
+
+/// The `write` implementation for STM32 FSMC.
+/// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32fsmcBackend`!
+void wgfxSTM32FSMCWrite(const WGFX_U8 *buf, WGFX_SIZET size, void *userPtr);
+
+/// The `writeRepeat` implementation for STM32 FSMC.
+/// Like `wgfxSTM32WriteRepeat()`, can only repeat pixels that consist of a repeated bus-wide value; returns false otherwise.
+/// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32fsmcBackend`!
+int wgfxSTM32FSMCWriteRepeat(const WGFX_U8 *pixel, WGFX_SIZET count, void *userPtr);
+
+/// The `waitWrite` implementation for STM32 FSMC (see `wgfxSTM32WaitWrite()`).
+/// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32fsmcBackend`!
+void wgfxSTM32FSMCWaitWrite(const WGFX_U8 *buf, void *userPtr);
+
+/// The `endWrite` implementation for STM32 FSMC.
+/// Set the `userPtr` of the `WGFXscreen` to point to a valid `WGFXstm32fsmcBackend`!
+void wgfxSTM32FSMCEndWrite(void *userPtr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEEGFX_STM32FSMC_H
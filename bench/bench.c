@@ -0,0 +1,577 @@
+// bench/bench.c - Host-side benchmarks for weegfx, on a mock backend that counts bus traffic.
+// Copyright (c) 2019 Paolo Jovon <paolo.jovon@gmail.com>
+// Released under the 3-clause BSD license (see LICENSE)
+//
+// Build and run with `make run` (see the Makefile). Pass a substring as the first argument to only run the
+// benchmarks whose name contains it (e.g. `./bench text/`).
+//
+// Each benchmark is first run twice (single- and double-buffered) on a mock backend whose writes stay in flight until
+// `waitWrite()` covers them, checking that the library never renders over data that is still being sent; the bench
+// exits with an error if it does.
+//
+// For each benchmark it prints:
+// - ns/px: host CPU time spent in weegfx per pixel sent to the screen (the mock backend does not touch the data);
+// - win/op, wr/op, B/op: `beginWrite()` calls, `write()` calls and bytes written per operation;
+// - bus/px: estimated bytes on the bus per pixel, counting `BENCH_WINDOW_BYTES` for the setup of each window.
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "weegfx.h"
+
+// Bytes sent to (a typical SPI) display controller to set an address window up:
+// e.g. ILI9341 CASET + 4 bytes, PASET + 4 bytes, RAMWR.
+#ifndef BENCH_WINDOW_BYTES
+#    define BENCH_WINDOW_BYTES 11
+#endif
+
+// Minimum time to spend on each benchmark.
+#ifndef BENCH_MIN_NS
+#    define BENCH_MIN_NS 20000000ull
+#endif
+
+#define SCREEN_W 320
+#define SCREEN_H 240
+
+// -- In-flight write checker -------------------------------------------------------------------------------------------
+
+// The writes that a DMA backend could still be sending: each is only done once `waitWrite()` is called for a region
+// overlapping it (or once `BENCH_IN_FLIGHT` newer writes were made, as if the backend had waited for a free slot).
+#define BENCH_IN_FLIGHT 32
+
+typedef struct
+{
+    const WGFX_U8 *buf;
+    WGFX_SIZET size;
+    unsigned long hash; ///< Of the data when it was written; it must not have changed until the write is done.
+} BenchInFlight;
+
+static BenchInFlight inFlight[BENCH_IN_FLIGHT];
+static unsigned nInFlight;
+static int checkWrites;
+static unsigned long long overwrites;
+
+static unsigned long hashData(const WGFX_U8 *data, WGFX_SIZET size)
+{
+    unsigned long hash = 2166136261ul;
+    for(WGFX_SIZET i = 0; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * 16777619ul;
+    }
+    return hash;
+}
+
+/// Completes the `index`-th write in flight, counting it as overwritten if its data changed meanwhile.
+static void completeWrite(unsigned index)
+{
+    if(hashData(inFlight[index].buf, inFlight[index].size) != inFlight[index].hash)
+    {
+        overwrites++;
+    }
+    nInFlight--;
+    memmove(&inFlight[index], &inFlight[index + 1], (nInFlight - index) * sizeof(inFlight[0]));
+}
+
+static void checkWaitWrite(const WGFX_U8 *buf, void *userPtr)
+{
+    const WGFX_U8 *begin, *end;
+    wgfxWaitWriteRegion((const WGFXscreen *)userPtr, buf, &begin, &end);
+    for(unsigned i = 0; i < nInFlight;)
+    {
+        if(inFlight[i].buf < end && begin < inFlight[i].buf + inFlight[i].size)
+        {
+            completeWrite(i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+// -- Counting mock backend ---------------------------------------------------------------------------------------------
+
+typedef struct
+{
+    unsigned long long windows, writes, bytes, pixels;
+} BenchCounters;
+
+static BenchCounters counters;
+static unsigned benchBpp;
+
+static void benchBeginWrite(unsigned x, unsigned y, unsigned w, unsigned h, void *userPtr)
+{
+    (void)x, (void)y, (void)w, (void)h, (void)userPtr;
+    counters.windows++;
+}
+
+static void benchWrite(const WGFX_U8 *data, WGFX_SIZET size, void *userPtr)
+{
+    (void)userPtr;
+    if(checkWrites && size > 0)
+    {
+        if(nInFlight == BENCH_IN_FLIGHT)
+        {
+            completeWrite(0);
+        }
+        inFlight[nInFlight].buf = data;
+        inFlight[nInFlight].size = size;
+        inFlight[nInFlight].hash = hashData(data, size);
+        nInFlight++;
+    }
+    counters.writes++;
+    counters.bytes += size;
+    counters.pixels += size / benchBpp;
+}
+
+static int benchWriteRepeat(const WGFX_U8 *pixel, WGFX_SIZET count, void *userPtr)
+{
+    (void)pixel, (void)userPtr;
+    counters.writes++;
+    counters.bytes += count * benchBpp;
+    counters.pixels += count;
+    return 1;
+}
+
+static void benchEndWrite(void *userPtr)
+{
+    (void)userPtr;
+}
+
+static void benchScroll(unsigned top, unsigned height, unsigned offset, void *userPtr)
+{
+    (void)top, (void)height, (void)offset, (void)userPtr;
+    counters.windows++; // (e.g. ILI9341 VSCRSADD + 2 bytes: counted as much bus traffic as an address window)
+}
+
+static unsigned long long nowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec;
+}
+
+// -- Test data ---------------------------------------------------------------------------------------------------------
+
+static WGFX_U8 font5x7Data[95 * 7], font8x8Data[95 * 8], font12x16Data[95 * 32];
+static const WGFXmonoFont font5x7 = {5, 7, 32, 126, font5x7Data, 7, 0, 0, 0};
+static const WGFXmonoFont font8x8 = {8, 8, 32, 126, font8x8Data, 8, 0, 0, 0};
+static const WGFXmonoFont font12x16 = {12, 16, 32, 126, font12x16Data, 32, 0, 0, 0};
+
+// (`font12x16`, pre-rotated by 90 degrees: 16x12 characters)
+static WGFX_U8 font12x16Rot90Data[95 * 24];
+static const WGFXmonoFont font12x16Rot90 = {12, 16, 32, 126, font12x16Rot90Data, 24, WGFX_FONT_ROTATED_90, 0, 0};
+
+// (anti-aliased, 4 bits of coverage per pixel)
+static WGFX_U8 font12x16AA4Data[95 * 96];
+static const WGFXmonoFont font12x16AA4 = {12, 16, 32, 126, font12x16AA4Data, 96, WGFX_FONT_AA4, 0, 0};
+
+#define IMAGE_W 96
+#define IMAGE_H 64
+static WGFX_U8 image[IMAGE_W * IMAGE_H * 4];
+
+static const WGFX_U8 fgColor[4] = {0xFF, 0xEE, 0xDD, 0xCC}, bgColor[4] = {0x01, 0x02, 0x03, 0x04};
+
+static const char *const text = "The quick brown fox jumps over the lazy dog.\n"
+                                "Pack my box with five dozen liquor jugs!\n"
+                                "0123456789 +-*/ ()[]{} <>=?@#$%&\n"
+                                "Sphinx of black quartz, judge my vow; how vexingly quick daft zebras jump.";
+
+static void initTestData(void)
+{
+    unsigned seed = 12345;
+    for(WGFX_SIZET i = 0; i < sizeof(font5x7Data); i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        font5x7Data[i] = (WGFX_U8)(seed >> 16) & 0xF8;
+    }
+    for(WGFX_SIZET i = 0; i < sizeof(font8x8Data); i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        font8x8Data[i] = (WGFX_U8)(seed >> 16);
+    }
+    for(WGFX_SIZET i = 0; i < sizeof(font12x16Data); i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        font12x16Data[i] = (WGFX_U8)(seed >> 16) & ((i % 2) ? 0xF0 : 0xFF);
+    }
+    for(WGFX_SIZET i = 0; i < sizeof(font12x16AA4Data); i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        font12x16AA4Data[i] = (WGFX_U8)(seed >> 16);
+    }
+    for(unsigned ch = 0; ch < 95; ch++)
+    {
+        // Rotated row `row` = column `row` of the character, bottom to top
+        const WGFX_U8 *const src = font12x16Data + ch * 32;
+        WGFX_U8 *const dst = font12x16Rot90Data + ch * 24;
+        for(unsigned row = 0; row < 12; row++)
+        {
+            for(unsigned col = 0; col < 16; col++)
+            {
+                const unsigned srcRow = 15 - col;
+                if((src[srcRow * 2 + row / 8] << (row % 8)) & 0x80)
+                {
+                    dst[row * 2 + col / 8] |= 0x80 >> (col % 8);
+                }
+            }
+        }
+    }
+    for(WGFX_SIZET i = 0; i < sizeof(image); i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        image[i] = (WGFX_U8)(seed >> 16);
+    }
+}
+
+// -- Benchmarks --------------------------------------------------------------------------------------------------------
+
+/// Parameters of a benchmark operation.
+typedef struct
+{
+    const WGFXmonoFont *font;
+    unsigned scale;
+    WGFXwrapMode wrapMode;
+    WGFXbitmapFlags bitmapFlags;
+    unsigned w, h;
+    WGFXscreenFlags screenFlags;
+    WGFXglyphCache *glyphCache;
+    WGFXrotation rotation;
+    int scroll; ///< Give the screen a `scroll()`?
+} BenchParams;
+
+/// Runs a benchmarked operation once.
+typedef void (*BenchOpPFN)(WGFXscreen *screen, const BenchParams *params);
+
+static void opFillRect(WGFXscreen *screen, const BenchParams *params)
+{
+    wgfxFillRect(screen, 7, 5, params->w, params->h, fgColor);
+}
+
+static void opTextMono(WGFXscreen *screen, const BenchParams *params)
+{
+    unsigned x = 3, y = 2;
+    wgfxDrawTextMono(screen, text, 0, &x, &y, params->font, params->scale, fgColor, bgColor, params->wrapMode);
+}
+
+#ifndef WGFX_NO_CLIPPING
+static void opTextBlockClipped(WGFXscreen *screen, const BenchParams *params)
+{
+    unsigned x = 3, y = 2;
+    wgfxPushClip(screen, 20, 5, 150, 30);
+    wgfxDrawTextBlockMono(screen, text, 0, &x, &y, params->font, params->scale, fgColor, bgColor, params->wrapMode);
+    wgfxPopClip(screen);
+}
+#endif
+
+static void opClock(WGFXscreen *screen, const BenchParams *params)
+{
+    unsigned x = 3, y = 2;
+    wgfxDrawTextMono(screen, "12:34:59", 0, &x, &y, params->font, params->scale, fgColor, bgColor, params->wrapMode);
+}
+
+static void opUpdateClock(WGFXscreen *screen, const BenchParams *params)
+{
+    wgfxUpdateTextMono(screen, "12:34:59", "12:35:00", 0, 3, 2, params->font, params->scale, fgColor, bgColor, params->wrapMode);
+}
+
+static void opBitmap(WGFXscreen *screen, const BenchParams *params)
+{
+    wgfxDrawBitmap(screen, image, IMAGE_W, IMAGE_H, 11, 13, params->w, params->h, params->bitmapFlags);
+}
+
+// A frame and 9 stacked segments, 6 of them lit: a typical bar-graph widget.
+#define BAR_SEGMENTS 9
+static WGFXrect barRects[4 + BAR_SEGMENTS];
+static WGFX_U8 barColors[4 + BAR_SEGMENTS];
+static const WGFXcolor barPalette[2] = {fgColor, bgColor};
+
+static void initBarGraph(void)
+{
+    static const WGFXrect frame[4] = {{40, 20, 24, 1}, {40, 20, 1, 2 + 8 * BAR_SEGMENTS}, {63, 20, 1, 2 + 8 * BAR_SEGMENTS},
+                                      {40, 21 + 8 * BAR_SEGMENTS, 24, 1}};
+    for(unsigned i = 0; i < 4; i++)
+    {
+        barRects[i] = frame[i];
+        barColors[i] = 0;
+    }
+    for(unsigned i = 0; i < BAR_SEGMENTS; i++)
+    {
+        const WGFXrect segment = {41, 21 + 8 * i, 22, 8};
+        barRects[4 + i] = segment;
+        barColors[4 + i] = (i < BAR_SEGMENTS - 6) ? 1 : 0;
+    }
+}
+
+static void opBarGraph(WGFXscreen *screen, const BenchParams *params)
+{
+    (void)params;
+    for(unsigned i = 0; i < 4 + BAR_SEGMENTS; i++)
+    {
+        wgfxFillRect(screen, barRects[i].x, barRects[i].y, barRects[i].w, barRects[i].h, barPalette[barColors[i]]);
+    }
+}
+
+static void opBarGraphBatched(WGFXscreen *screen, const BenchParams *params)
+{
+    (void)params;
+    wgfxFillRectsIndexed(screen, barRects, barColors, 4 + BAR_SEGMENTS, barPalette);
+}
+
+static void opLine(WGFXscreen *screen, const BenchParams *params)
+{
+    (void)params;
+    wgfxDrawLine(screen, 5, 200, 300, 10, fgColor);
+}
+
+static void opFillCircle(WGFXscreen *screen, const BenchParams *params)
+{
+    (void)params;
+    wgfxFillCircle(screen, 160, 120, 60, fgColor, 0);
+}
+
+static void opFillCircleBg(WGFXscreen *screen, const BenchParams *params)
+{
+    (void)params;
+    wgfxFillCircle(screen, 160, 120, 60, fgColor, bgColor);
+}
+
+// Fills a whole-screen console, then appends as many lines again: a full page is scrolled away, a line at a time.
+static void opConsole(WGFXscreen *screen, const BenchParams *params)
+{
+    const unsigned lines = screen->height / (params->font->height * params->scale);
+    WGFXconsole console;
+    wgfxConsoleInit(&console, screen, 0, lines, params->font, params->scale, fgColor, bgColor);
+    for(unsigned i = 0; i < 2 * lines; i++)
+    {
+        wgfxConsolePutLine(&console, "[12:34:59] sensor 3: 21.5 C", 0);
+    }
+}
+
+// Room for 16 12x16 characters at up to 3 bpp.
+static void *glyphCacheArena[(16 * (sizeof(WGFXglyphCacheSlot) + 12 * 16 * 3)) / sizeof(void *) + 1];
+static WGFXglyphCache glyphCache;
+
+static const char *filter = 0;
+static int failed = 0;
+
+/// Runs `op` twice on `screen` with writes kept in flight (see `checkWaitWrite()`), so that the second run starts with
+/// the writes of the first one still in flight; returns the number of writes whose data was overwritten before they
+/// were done.
+static unsigned long long checkOp(BenchOpPFN op, WGFXscreen *screen, const BenchParams *params)
+{
+    checkWrites = 1;
+    overwrites = 0;
+    op(screen, params);
+    op(screen, params);
+    while(nInFlight > 0)
+    {
+        completeWrite(0);
+    }
+    checkWrites = 0;
+    return overwrites;
+}
+
+static void runBench(const char *name, BenchOpPFN op, const BenchParams *params,
+                     unsigned bpp, WGFX_SIZET scratchSize, int writeRepeat)
+{
+    char fullName[96];
+    snprintf(fullName, sizeof(fullName), "%s/bpp%u/scratch%lu%s", name, bpp, (unsigned long)scratchSize,
+             writeRepeat ? "/repeat" : "");
+    if(filter && !strstr(fullName, filter))
+    {
+        return;
+    }
+
+    WGFX_U8 *scratch = malloc(scratchSize * bpp);
+    WGFXscreen screen;
+    memset(&screen, 0, sizeof(screen));
+    const int swapSize = params->rotation == WGFX_ROTATE_90 || params->rotation == WGFX_ROTATE_270;
+    screen.width = swapSize ? SCREEN_H : SCREEN_W;
+    screen.height = swapSize ? SCREEN_W : SCREEN_H;
+    screen.bpp = bpp;
+    screen.scratchData = scratch;
+    screen.scratchSize = scratchSize;
+    screen.beginWrite = benchBeginWrite;
+    screen.write = benchWrite;
+    screen.endWrite = benchEndWrite;
+    screen.writeRepeat = writeRepeat ? benchWriteRepeat : 0;
+    screen.scroll = params->scroll ? benchScroll : 0;
+    screen.flags = params->screenFlags;
+    screen.glyphCache = params->glyphCache;
+    screen.rotation = params->rotation;
+    screen.waitWrite = checkWaitWrite;
+    screen.userPtr = &screen;
+
+    benchBpp = bpp;
+    // (also warms up)
+    const unsigned long long overwritten = checkOp(op, &screen, params);
+    screen.flags = params->screenFlags | WGFX_SCREEN_DOUBLE_BUFFER;
+    const unsigned long long overwrittenDB = checkOp(op, &screen, params);
+    screen.flags = params->screenFlags;
+    screen.scratchHalf = 0;
+    screen.waitWrite = 0; // (the timed runs are on a synchronous backend)
+    if(overwritten > 0 || overwrittenDB > 0)
+    {
+        printf("%-44s %llu (%llu double-buffered) writes overwritten while in flight!\n", fullName, overwritten,
+               overwrittenDB);
+        failed = 1;
+    }
+
+    memset(&counters, 0, sizeof(counters));
+    unsigned long long nOps = 0;
+    const unsigned long long start = nowNs();
+    unsigned long long elapsed = 0;
+    do
+    {
+        op(&screen, params);
+        nOps++;
+        elapsed = nowNs() - start;
+    } while(elapsed < BENCH_MIN_NS);
+    free(scratch);
+
+    if(counters.pixels == 0)
+    {
+        printf("%-44s (nothing drawn - scratch buffer too small?)\n", fullName);
+        return;
+    }
+    const double busBytes = (double)counters.bytes + (double)counters.windows * BENCH_WINDOW_BYTES;
+    printf("%-44s %9.2f %9.1f %9.1f %10.0f %8.3f\n", fullName,
+           (double)elapsed / (double)counters.pixels,
+           (double)counters.windows / (double)nOps,
+           (double)counters.writes / (double)nOps,
+           (double)counters.bytes / (double)nOps,
+           busBytes / (double)counters.pixels);
+}
+
+int main(int argc, char **argv)
+{
+    filter = (argc > 1) ? argv[1] : 0;
+    initTestData();
+    initBarGraph();
+
+    static const unsigned bpps[] = {1, 2, 3};
+    static const WGFX_SIZET scratchSizes[] = {64, 512, 4096};
+    static const struct
+    {
+        const char *name;
+        WGFXwrapMode mode;
+    } wrapModes[] = {
+        {"nowrap", 0},
+        {"newline", WGFX_WRAP_NEWLINE},
+        {"right", WGFX_WRAP_RIGHT},
+        {"both", WGFX_WRAP_NEWLINE | WGFX_WRAP_RIGHT},
+    };
+    static const struct
+    {
+        const char *name;
+        const WGFXmonoFont *font;
+    } fonts[] = {
+        {"5x7", &font5x7},
+        {"8x8", &font8x8},
+        {"12x16", &font12x16},
+    };
+
+    printf("%-44s %9s %9s %9s %10s %8s\n", "benchmark", "ns/px", "win/op", "wr/op", "B/op", "bus/px");
+    for(unsigned iBpp = 0; iBpp < sizeof(bpps) / sizeof(bpps[0]); iBpp++)
+    {
+        const unsigned bpp = bpps[iBpp];
+        for(unsigned iScratch = 0; iScratch < sizeof(scratchSizes) / sizeof(scratchSizes[0]); iScratch++)
+        {
+            const WGFX_SIZET scratchSize = scratchSizes[iScratch];
+            char name[64];
+            BenchParams params;
+            memset(&params, 0, sizeof(params));
+
+            params.w = 200;
+            params.h = 150;
+            runBench("fill/200x150", opFillRect, &params, bpp, scratchSize, 0);
+            runBench("fill/200x150", opFillRect, &params, bpp, scratchSize, 1);
+            params.w = 3;
+            params.h = 3;
+            runBench("fill/3x3", opFillRect, &params, bpp, scratchSize, 0);
+            runBench("bargraph/rects", opBarGraph, &params, bpp, scratchSize, 0);
+            runBench("bargraph/batch", opBarGraphBatched, &params, bpp, scratchSize, 0);
+            runBench("shape/line", opLine, &params, bpp, scratchSize, 0);
+            runBench("shape/circle", opFillCircle, &params, bpp, scratchSize, 0);
+            runBench("shape/circle-bg", opFillCircleBg, &params, bpp, scratchSize, 0);
+
+            for(unsigned iFont = 0; iFont < sizeof(fonts) / sizeof(fonts[0]); iFont++)
+            {
+                for(unsigned iWrap = 0; iWrap < sizeof(wrapModes) / sizeof(wrapModes[0]); iWrap++)
+                {
+                    for(unsigned scale = 1; scale <= 4; scale++)
+                    {
+                        params.font = fonts[iFont].font;
+                        params.scale = scale;
+                        params.wrapMode = wrapModes[iWrap].mode;
+                        snprintf(name, sizeof(name), "text/%s/%s/x%u", fonts[iFont].name, wrapModes[iWrap].name, scale);
+                        runBench(name, opTextMono, &params, bpp, scratchSize, 0);
+                    }
+                }
+
+                // (1-bit mask scratch; only worth comparing against the above for one wrap mode)
+                params.wrapMode = WGFX_WRAP_NEWLINE | WGFX_WRAP_RIGHT;
+                params.screenFlags = WGFX_SCREEN_MASK_TEXT;
+                for(unsigned scale = 1; scale <= 2; scale++)
+                {
+                    params.scale = scale;
+                    snprintf(name, sizeof(name), "textmask/%s/both/x%u", fonts[iFont].name, scale);
+                    runBench(name, opTextMono, &params, bpp, scratchSize, 0);
+                }
+                params.screenFlags = 0;
+
+#ifndef WGFX_NO_CLIPPING
+                // (only rows and columns of the text block that are inside the clip rectangle are written)
+                params.scale = 1;
+                snprintf(name, sizeof(name), "textblock/%s/clipped", fonts[iFont].name);
+                runBench(name, opTextBlockClipped, &params, bpp, scratchSize, 0);
+#endif
+            }
+
+            params.font = &font8x8;
+            params.scale = 1;
+            params.wrapMode = 0;
+            params.scroll = 1;
+            runBench("console/8x8/scroll", opConsole, &params, bpp, scratchSize, 0);
+            params.scroll = 0;
+            runBench("console/8x8/noscroll", opConsole, &params, bpp, scratchSize, 0);
+
+            params.font = &font12x16;
+            runBench("clock/draw", opClock, &params, bpp, scratchSize, 0);
+            runBench("clock/update", opUpdateClock, &params, bpp, scratchSize, 0);
+            wgfxGlyphCacheInit(&glyphCache, glyphCacheArena, sizeof(glyphCacheArena), 12 * 16 * bpp);
+            params.glyphCache = &glyphCache;
+            runBench("clock/draw-cached", opClock, &params, bpp, scratchSize, 0);
+            params.glyphCache = 0;
+            params.font = &font12x16AA4;
+            runBench("clock/aa4", opClock, &params, bpp, scratchSize, 0);
+            params.font = &font12x16;
+
+            // (rotated by 90 degrees: reordering the pixels of unrotated characters vs. a pre-rotated font)
+            params.rotation = WGFX_ROTATE_90;
+            runBench("clock/rotated", opClock, &params, bpp, scratchSize, 0);
+            params.font = &font12x16Rot90;
+            runBench("clock/prerotated", opClock, &params, bpp, scratchSize, 0);
+            params.w = IMAGE_W;
+            params.h = IMAGE_H;
+            runBench("bitmap/ram-rotated", opBitmap, &params, bpp, scratchSize, 0);
+            params.rotation = WGFX_ROTATE_0;
+
+            params.w = IMAGE_W;
+            params.h = IMAGE_H;
+            params.bitmapFlags = 0;
+            runBench("bitmap/ram", opBitmap, &params, bpp, scratchSize, 0);
+            params.bitmapFlags = WGFX_BITMAP_RODATA;
+            runBench("bitmap/rodata", opBitmap, &params, bpp, scratchSize, 0);
+            params.w = IMAGE_W / 2;
+            params.bitmapFlags = 0;
+            runBench("bitmap/ram-clipped", opBitmap, &params, bpp, scratchSize, 0);
+            params.bitmapFlags = WGFX_BITMAP_RODATA;
+            runBench("bitmap/rodata-clipped", opBitmap, &params, bpp, scratchSize, 0);
+        }
+    }
+    return failed;
+}
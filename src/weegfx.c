@@ -4,383 +4,2039 @@
 #include "weegfx.h"
 
 #include "weegfx/base.h"
+#include "weegfx/internal.h"
+#include "weegfx/kernels.h"
 
-#define MIN(x, y) (((x) < (y)) ? (x) : (y))
-#define MAX(x, y) (((x) >= (y)) ? (x) : (y))
+#ifndef WGFX_NO_CLIPPING
+int wgfxPushClip(WGFXscreen *self, unsigned x, unsigned y, unsigned w, unsigned h)
+{
+    if(self->clipDepth >= WGFX_CLIP_STACK_SIZE)
+    {
+        return 0;
+    }
+    clipRect(self, &x, &y, &w, &h, 0, 0); // (if empty, everything will be clipped away until this is popped)
+
+    WGFXrect *const clip = &self->clipStack[self->clipDepth++];
+    clip->x = x;
+    clip->y = y;
+    clip->w = w;
+    clip->h = h;
+    return 1;
+}
+
+void wgfxPopClip(WGFXscreen *self)
+{
+    if(self->clipDepth > 0)
+    {
+        self->clipDepth--;
+    }
+}
+#endif
+
+void wgfxWaitWriteRegion(const WGFXscreen *self, const WGFX_U8 *buf, const WGFX_U8 **begin, const WGFX_U8 **end)
+{
+    const WGFX_SIZET scratchSizeB = self->scratchSize * self->bpp;
+    if(buf < self->scratchData || buf >= self->scratchData + scratchSizeB)
+    {
+        // (other buffers - i.e. the rotate buffer - are always written from their start)
+        *begin = buf;
+        *end = buf + 1;
+        return;
+    }
+
+    *begin = self->scratchData;
+    *end = self->scratchData + scratchSizeB;
+    if(self->flags & WGFX_SCREEN_DOUBLE_BUFFER)
+    {
+        const WGFX_U8 *const secondHalf = self->scratchData + (self->scratchSize / 2) * self->bpp;
+        if(buf < secondHalf)
+        {
+            *end = secondHalf;
+        }
+        else
+        {
+            *begin = secondHalf;
+        }
+    }
+}
+
+int wgfxWaitWriteOverlaps(const WGFXscreen *self, const WGFX_U8 *buf, const WGFX_U8 *xferBuf, WGFX_SIZET size)
+{
+    const WGFX_U8 *begin, *end;
+    wgfxWaitWriteRegion(self, buf, &begin, &end);
+    return size > 0 && xferBuf < end && begin < xferBuf + size;
+}
+
+/// Size in bytes of the buffer on the stack that pixels are reordered into when a screen has no `rotateData` (and the
+/// window has no bigger `rotateSpare`).
+#define ROTATE_STACK_BUFFER_SIZE 128
+
+void wgfxBeginRotatedWrite(WGFXscreen *self, unsigned x, unsigned y, unsigned w, unsigned h)
+{
+    self->rotateWindow.x = x;
+    self->rotateWindow.y = y;
+    self->rotateWindow.w = w;
+    self->rotateWindow.h = h;
+    self->rotatePos = 0;
+    self->rotateState = WGFX_ROTATE_REORDERING;
+    self->rotateSpare = 0;
+    self->rotateSpareSize = 0;
+}
+
+/// Writes the `w * h` block of pixels at `x`, `y` (as drawn to; rows `stride` bytes apart in `data`) to a rotated
+/// screen, reordering them into the rotate buffer (or the window's `rotateSpare`, or else the stack) and sending them one
+/// address window's worth at a time.
+static void writeRotatedBlock(WGFXscreen *self, const WGFX_U8 *data, WGFX_SIZET stride, unsigned x, unsigned y,
+                              unsigned w, unsigned h)
+{
+    const unsigned bpp = self->bpp;
+    WGFX_U8 stackBuffer[ROTATE_STACK_BUFFER_SIZE];
+    WGFX_U8 *buffer = self->rotateData;
+    WGFX_SIZET bufferPixels = self->rotateSize;
+    if(!buffer || bufferPixels == 0)
+    {
+        buffer = self->rotateSpare;
+        bufferPixels = self->rotateSpareSize / bpp;
+        if(!buffer || self->rotateSpareSize <= sizeof(stackBuffer))
+        {
+            buffer = stackBuffer;
+            bufferPixels = sizeof(stackBuffer) / bpp;
+        }
+    }
+
+    unsigned px = x, py = y, pw = w, ph = h;
+    rotateRect(self->rotation, self->width, self->height, &px, &py, &pw, &ph);
+
+    // Whole (stored) rows at a time if they fit the buffer, otherwise parts of a row
+    const unsigned rowsPerWindow = (unsigned)MIN(bufferPixels / pw, ph);
+    for(unsigned row = 0; row < ph;)
+    {
+        const unsigned nRows = (rowsPerWindow > 0) ? MIN(rowsPerWindow, ph - row) : 1;
+        for(unsigned col = 0; col < pw;)
+        {
+            const unsigned nCols = (rowsPerWindow > 0) ? pw : (unsigned)MIN(bufferPixels, pw - col);
+            screenWaitWrite(self, buffer);
+            WGFX_U8 *dst = buffer;
+            for(unsigned i = 0; i < nRows; i++)
+            {
+                long step;
+                const WGFX_U8 *const src = rotatedRow(self->rotation, data, stride, bpp, w, h, row + i, &step);
+                for(unsigned j = 0; j < nCols; j++)
+                {
+                    copyPixel(dst, src + (long)(col + j) * step, bpp);
+                    dst += bpp;
+                }
+            }
+
+            if(self->rotateState & WGFX_ROTATE_WINDOW_OPEN)
+            {
+                screenBackendEndWrite(self);
+            }
+            screenBackendBeginWrite(self, px + col, py + row, nCols, nRows);
+            self->rotateState |= WGFX_ROTATE_WINDOW_OPEN;
+            screenBackendWrite(self, buffer, (WGFX_SIZET)nRows * nCols * bpp);
+            col += nCols;
+        }
+        row += nRows;
+    }
+
+    if(buffer == stackBuffer)
+    {
+        screenWaitWrite(self, stackBuffer); // (it is gone after returning)
+    }
+}
+
+void wgfxRotatedWrite(WGFXscreen *self, const WGFX_U8 *buf, WGFX_SIZET size)
+{
+    const WGFXrect *const window = &self->rotateWindow;
+    const unsigned bpp = self->bpp;
+    for(WGFX_SIZET n = size / bpp; n > 0;)
+    {
+        // Split the pixels into the rest of the current row, or as many whole rows as possible
+        const unsigned col = (unsigned)(self->rotatePos % window->w), row = (unsigned)(self->rotatePos / window->w);
+        unsigned w = window->w, h = 1;
+        if(col == 0 && n >= window->w)
+        {
+            h = (unsigned)(n / window->w);
+        }
+        else
+        {
+            w = (unsigned)MIN(window->w - col, n);
+        }
+        writeRotatedBlock(self, buf, (WGFX_SIZET)w * bpp, window->x + col, window->y + row, w, h);
+
+        const WGFX_SIZET count = (WGFX_SIZET)w * h;
+        buf += count * bpp;
+        n -= count;
+        self->rotatePos += count;
+    }
+}
+
+void wgfxEndRotatedWrite(WGFXscreen *self)
+{
+    if(self->rotateState & WGFX_ROTATE_WINDOW_OPEN)
+    {
+        screenBackendEndWrite(self);
+    }
+    self->rotateState = 0;
+    self->rotateSpare = 0;
+    self->rotateSpareSize = 0;
+}
+
+void wgfxBatchFillRect(WGFXscreen *self, WGFXfillBatch *batch, unsigned x, unsigned y, unsigned w, unsigned h,
+                       const WGFXcolor color)
+{
+    const WGFX_SIZET xferCount = (WGFX_SIZET)w * h;
+
+    screenBeginWriteRotated(self, x, y, w, h); // (all pixels are the same: no need to reorder them)
+    if(!screenWriteRepeat(self, (const WGFX_U8 *)color, xferCount))
+    {
+        if(!batch->scratch || batch->color != color)
+        {
+            // (the same pixels are sent over and over, so there is no need to alternate scratch halves for each rect;
+            // only when the color changes, so that the previous one can still be sent while filling)
+            batch->scratch = acquireScratch(self);
+            batch->filledCount = 0;
+            batch->color = color;
+        }
+        const WGFX_SIZET fillCount = MIN(scratchPixels(self), xferCount);
+        if(fillCount > batch->filledCount)
+        {
+            // (only touches the pixels after the ones that may still be being sent)
+            fillPixels(batch->scratch + batch->filledCount * self->bpp, (const WGFX_U8 *)color, self->bpp,
+                       fillCount - batch->filledCount);
+            batch->filledCount = fillCount;
+        }
+
+        // Fill rect in chunks (or all at once, if it fits the scratch buffer)
+        const WGFX_SIZET xferSizeB = xferCount * self->bpp;
+        const WGFX_SIZET scratchSizeB = batch->filledCount * self->bpp;
+        WGFX_SIZET chunkSizeB;
+        for(WGFX_SIZET sentB = 0; sentB < xferSizeB; sentB += chunkSizeB)
+        {
+            chunkSizeB = MIN(scratchSizeB, xferSizeB - sentB);
+            screenWrite(self, batch->scratch, chunkSizeB);
+        }
+    }
+    screenEndWrite(self);
+}
+
+void wgfxFillRect(WGFXscreen *self, unsigned x, unsigned y, unsigned w, unsigned h, const WGFXcolor color)
+{
+    if(!clipRect(self, &x, &y, &w, &h, 0, 0))
+    {
+        return;
+    }
+
+    WGFXfillBatch batch = {0};
+    wgfxBatchFillRect(self, &batch, x, y, w, h, color);
+}
+
+/// If the `a` and `b` rectangles (both not empty) together make up a rectangle, stores it to `*a` and returns true.
+static int mergeRects(WGFXrect *a, const WGFXrect *b)
+{
+    if(b->x >= a->x && b->x + b->w <= a->x + a->w && b->y >= a->y && b->y + b->h <= a->y + a->h)
+    {
+        return 1; // (`b` is inside `a`)
+    }
+    if(a->x >= b->x && a->x + a->w <= b->x + b->w && a->y >= b->y && a->y + a->h <= b->y + b->h)
+    {
+        *a = *b; // (`a` is inside `b`)
+        return 1;
+    }
+    if(a->x == b->x && a->w == b->w && (a->y + a->h == b->y || b->y + b->h == a->y))
+    {
+        // Stacked vertically
+        a->y = MIN(a->y, b->y);
+        a->h += b->h;
+        return 1;
+    }
+    if(a->y == b->y && a->h == b->h && (a->x + a->w == b->x || b->x + b->w == a->x))
+    {
+        // Side by side
+        a->x = MIN(a->x, b->x);
+        a->w += b->w;
+        return 1;
+    }
+    return 0;
+}
+
+/// Implements `wgfxFillRects()` (if `colorIndices` is null, every rect uses `palette[0]`) and `wgfxFillRectsIndexed()`.
+static void fillRects(WGFXscreen *self, const WGFXrect *rects, const WGFX_U8 *colorIndices, unsigned count,
+                      const WGFXcolor *palette)
+{
+    WGFXfillBatch batch = {0};
+    WGFXrect run = {0, 0, 0, 0}; // (empty: no run yet)
+    unsigned runIndex = 0;
+    for(unsigned i = 0; i < count; i++)
+    {
+        if(rects[i].w == 0 || rects[i].h == 0)
+        {
+            continue;
+        }
+
+        const unsigned index = colorIndices ? colorIndices[i] : 0;
+        if(run.w != 0 && index == runIndex && mergeRects(&run, &rects[i]))
+        {
+            continue;
+        }
+
+        // Can't grow the current run any further: fill it and start a new one
+        if(clipRect(self, &run.x, &run.y, &run.w, &run.h, 0, 0))
+        {
+            wgfxBatchFillRect(self, &batch, run.x, run.y, run.w, run.h, palette[runIndex]);
+        }
+        run = rects[i];
+        runIndex = index;
+    }
+    if(clipRect(self, &run.x, &run.y, &run.w, &run.h, 0, 0))
+    {
+        wgfxBatchFillRect(self, &batch, run.x, run.y, run.w, run.h, palette[runIndex]);
+    }
+}
+
+void wgfxFillRects(WGFXscreen *self, const WGFXrect *rects, unsigned count, const WGFXcolor color)
+{
+    fillRects(self, rects, 0, count, &color);
+}
+
+void wgfxFillRectsIndexed(WGFXscreen *self, const WGFXrect *rects, const WGFX_U8 *colorIndices, unsigned count,
+                          const WGFXcolor *palette)
+{
+    fillRects(self, rects, colorIndices, count, palette);
+}
+
+/// Writes a character at any scale, one font bit at a time.
+static void writeMonoCharGeneric(const WGFXmonoTextCtx *ctx, const WGFX_U8 *data,
+                                 WGFX_U8 *buffer, unsigned rowStride, unsigned width, unsigned height)
+{
+    const unsigned bpp = ctx->bpp, scale = ctx->scale;
+    const unsigned dataRowStride = (ctx->font->width + 7) / 8; // Bytes per row of font data
+    const unsigned charRowStride = width * bpp;                // Length in bytes of a character row
+
+    for(unsigned row = 0; row < height; row += scale)
+    {
+        WGFX_U8 *bufPtr = buffer;
+        WGFX_U8 dataByte = 0;
+        for(unsigned col = 0, dataBit = 0; col < width; col += scale, dataBit++)
+        {
+            if((dataBit & 0x7) == 0)
+            {
+                dataByte = WGFX_RODATA_READU8(data + dataBit / 8);
+            }
+            const WGFX_U8 *const color = (dataByte & 0x80) ? ctx->fgColor : ctx->bgColor;
+            dataByte <<= 1;
+
+            const unsigned nPixels = MIN(scale, width - col); //< (to upscale horizontally)
+            fillPixels(bufPtr, color, bpp, nPixels);
+            bufPtr += nPixels * bpp;
+        }
+        data += dataRowStride;
+
+        buffer = repeatRow(buffer, rowStride, charRowStride, MIN(scale, height - row)); //< (to upscale vertically)
+    }
+}
+
+/// Like `writeMonoCharGeneric()`, but for `WGFX_FONT_PACKED` fonts (streaming bits across rows).
+static void writeMonoCharPacked(const WGFXmonoTextCtx *ctx, const WGFX_U8 *data,
+                                WGFX_U8 *buffer, unsigned rowStride, unsigned width, unsigned height)
+{
+    const unsigned bpp = ctx->bpp, scale = ctx->scale;
+    const unsigned rowBits = (width + scale - 1) / scale;   // Font bits used per row
+    const unsigned skippedBits = ctx->font->width - rowBits; // Font bits clipped out per row
+    const unsigned charRowStride = width * bpp;
+
+    WGFXbitReader reader;
+    initBitReader(&reader, data);
+    for(unsigned row = 0; row < height; row += scale)
+    {
+        WGFX_U8 *bufPtr = buffer;
+        for(unsigned col = 0; col < width; col += scale)
+        {
+            const WGFX_U8 *const color = readBits(&reader, 1) ? ctx->fgColor : ctx->bgColor;
+
+            const unsigned nPixels = MIN(scale, width - col); //< (to upscale horizontally)
+            fillPixels(bufPtr, color, bpp, nPixels);
+            bufPtr += nPixels * bpp;
+        }
+        skipBits(&reader, skippedBits);
+
+        buffer = repeatRow(buffer, rowStride, charRowStride, MIN(scale, height - row)); //< (to upscale vertically)
+    }
+}
+
+#ifndef WGFX_NO_AA_FONTS
+
+/// Writes a character of an anti-aliased font at scale 1, a byte of font data at a time: one table lookup in
+/// `ctx->shades` per pixel. `pixelBits` and `bpp` are compile-time constants in the writers below.
+WGFX_FORCEINLINE static void writeMonoCharAAImpl(const WGFXmonoTextCtx *ctx, const WGFX_U8 *data,
+                                                 WGFX_U8 *buffer, unsigned rowStride, unsigned width, unsigned height,
+                                                 const unsigned pixelBits, const unsigned bpp)
+{
+    const unsigned pixelsPerByte = 8 / pixelBits, valueMask = (1u << pixelBits) - 1;
+    const unsigned dataRowStride = (ctx->font->width * pixelBits + 7) / 8;
+    const unsigned fullBytes = width / pixelsPerByte, lastPixels = width % pixelsPerByte;
+
+    const WGFX_U8 *const *const shades = ctx->shades;
+    for(unsigned row = 0; row < height; row++)
+    {
+        WGFX_U8 *bufPtr = buffer;
+        for(unsigned i = 0; i < fullBytes; i++)
+        {
+            const unsigned dataByte = WGFX_RODATA_READU8(data + i);
+            for(unsigned shift = 8 - pixelBits; shift < 8; shift -= pixelBits) //< (until it wraps around)
+            {
+                copyPixel(bufPtr, shades[(dataByte >> shift) & valueMask], bpp);
+                bufPtr += bpp;
+            }
+        }
+        if(lastPixels != 0)
+        {
+            const unsigned dataByte = WGFX_RODATA_READU8(data + fullBytes);
+            for(unsigned i = 0, shift = 8 - pixelBits; i < lastPixels; i++, shift -= pixelBits)
+            {
+                copyPixel(bufPtr, shades[(dataByte >> shift) & valueMask], bpp);
+                bufPtr += bpp;
+            }
+        }
+        data += dataRowStride;
+        buffer += rowStride;
+    }
+}
+
+/// Writes a (possibly clipped) character of an unpacked, 2-bit anti-aliased font at scale 1.
+static void writeMonoCharAA2(const WGFXmonoTextCtx *ctx, const WGFX_U8 *data,
+                             WGFX_U8 *buffer, unsigned rowStride, unsigned width, unsigned height)
+{
+    switch(WGFX_KERNEL_BPP(ctx->bpp))
+    {
+    case 1:
+        writeMonoCharAAImpl(ctx, data, buffer, rowStride, width, height, 2, 1);
+        break;
+    case 2:
+        writeMonoCharAAImpl(ctx, data, buffer, rowStride, width, height, 2, 2);
+        break;
+    case 3:
+        writeMonoCharAAImpl(ctx, data, buffer, rowStride, width, height, 2, 3);
+        break;
+    case 4:
+        writeMonoCharAAImpl(ctx, data, buffer, rowStride, width, height, 2, 4);
+        break;
+    default:
+        writeMonoCharAAImpl(ctx, data, buffer, rowStride, width, height, 2, ctx->bpp);
+        break;
+    }
+}
+
+/// Writes a (possibly clipped) character of an unpacked, 4-bit anti-aliased font at scale 1.
+static void writeMonoCharAA4(const WGFXmonoTextCtx *ctx, const WGFX_U8 *data,
+                             WGFX_U8 *buffer, unsigned rowStride, unsigned width, unsigned height)
+{
+    switch(WGFX_KERNEL_BPP(ctx->bpp))
+    {
+    case 1:
+        writeMonoCharAAImpl(ctx, data, buffer, rowStride, width, height, 4, 1);
+        break;
+    case 2:
+        writeMonoCharAAImpl(ctx, data, buffer, rowStride, width, height, 4, 2);
+        break;
+    case 3:
+        writeMonoCharAAImpl(ctx, data, buffer, rowStride, width, height, 4, 3);
+        break;
+    case 4:
+        writeMonoCharAAImpl(ctx, data, buffer, rowStride, width, height, 4, 4);
+        break;
+    default:
+        writeMonoCharAAImpl(ctx, data, buffer, rowStride, width, height, 4, ctx->bpp);
+        break;
+    }
+}
+
+/// Writes a character of an anti-aliased font at any scale (used for packed fonts and upscaled text), one table
+/// lookup in `ctx->shades` per font pixel.
+static void writeMonoCharAA(const WGFXmonoTextCtx *ctx, const WGFX_U8 *data,
+                            WGFX_U8 *buffer, unsigned rowStride, unsigned width, unsigned height)
+{
+    const unsigned bpp = ctx->bpp, scale = ctx->scale, pixelBits = monoFontPixelBits(ctx->font);
+    const unsigned rowBits = ctx->font->width * pixelBits;
+    const int packed = ctx->font->flags & WGFX_FONT_PACKED;
+    const unsigned dataRowStride = (rowBits + 7) / 8;                                // Bytes per row of font data (if not packed)
+    const unsigned skippedBits = rowBits - (width + scale - 1) / scale * pixelBits; // Font bits clipped out per row (if packed)
+    const unsigned charRowStride = width * bpp;
+
+    WGFXbitReader reader;
+    initBitReader(&reader, data);
+    for(unsigned row = 0; row < height; row += scale)
+    {
+        WGFX_U8 *bufPtr = buffer;
+        for(unsigned col = 0; col < width; col += scale)
+        {
+            const WGFX_U8 *const color = ctx->shades[readBits(&reader, pixelBits)];
+            const unsigned nPixels = MIN(scale, width - col); //< (to upscale horizontally)
+            fillPixels(bufPtr, color, bpp, nPixels);
+            bufPtr += nPixels * bpp;
+        }
+        if(packed)
+        {
+            skipBits(&reader, skippedBits);
+        }
+        else
+        {
+            data += dataRowStride;
+            initBitReader(&reader, data);
+        }
+
+        buffer = repeatRow(buffer, rowStride, charRowStride, MIN(scale, height - row)); //< (to upscale vertically)
+    }
+}
+
+#endif // WGFX_NO_AA_FONTS
+
+#ifndef WGFX_NO_GLYPH_LUT
+
+/// Writes a character through `ctx->lut`, 4 output pixels per table lookup.
+/// `scale` must be 1 or 2, and `dataRowStride` the bytes per row of font data; the specialized writers below
+/// invoke this with compile-time constants for them (and for `width`, for common font sizes).
+WGFX_FORCEINLINE static void writeMonoCharLUTImpl(const WGFXmonoTextCtx *ctx, const WGFX_U8 *data,
+                                                  WGFX_U8 *buffer, unsigned rowStride, unsigned width, unsigned height,
+                                                  const unsigned scale, const unsigned dataRowStride)
+{
+    const unsigned bpp = ctx->bpp;
+    const unsigned entryBits = 4 / scale, entryMask = (1u << entryBits) - 1;
+    const unsigned pixelsPerByte = 8 * scale;
+    const unsigned fullBytes = width / pixelsPerByte, lastPixels = width % pixelsPerByte;
+
+    for(unsigned row = 0; row < height; row += scale)
+    {
+        WGFX_U8 *bufPtr = buffer;
+        for(unsigned i = 0; i < fullBytes; i++)
+        {
+            const WGFX_U8 dataByte = WGFX_RODATA_READU8(data + i);
+            for(unsigned shift = 8 - entryBits; shift < 8; shift -= entryBits) //< (until it wraps around)
+            {
+                bufPtr = copyNibblePixels(bufPtr, &ctx->lut, (dataByte >> shift) & entryMask, bpp, 4);
+            }
+        }
+        if(lastPixels != 0)
+        {
+            // Last, partial byte (either the font's width is not a multiple of 8 or the char is clipped)
+            const WGFX_U8 dataByte = WGFX_RODATA_READU8(data + fullBytes);
+            unsigned pixelsLeft = lastPixels;
+            for(unsigned shift = 8 - entryBits; pixelsLeft > 0; shift -= entryBits)
+            {
+                const unsigned nPixels = MIN(pixelsLeft, 4);
+                bufPtr = copyNibblePixels(bufPtr, &ctx->lut, (dataByte >> shift) & entryMask, bpp, nPixels);
+                pixelsLeft -= nPixels;
+            }
+        }
+        data += dataRowStride;
+
+        if(scale == 1)
+        {
+            buffer += rowStride;
+        }
+        else
+        {
+            buffer = repeatRow(buffer, rowStride, width * bpp, MIN(scale, height - row));
+        }
+    }
+}
+
+/// Writes a (possibly clipped) character of any width at scale 1 through the LUT.
+static void writeMonoCharLUT1(const WGFXmonoTextCtx *ctx, const WGFX_U8 *data,
+                              WGFX_U8 *buffer, unsigned rowStride, unsigned width, unsigned height)
+{
+    writeMonoCharLUTImpl(ctx, data, buffer, rowStride, width, height, 1, (ctx->font->width + 7) / 8);
+}
+
+/// Writes a whole character of a 8-pixel-wide font at scale 1 through the LUT.
+static void writeMonoCharLUT1W8(const WGFXmonoTextCtx *ctx, const WGFX_U8 *data,
+                                WGFX_U8 *buffer, unsigned rowStride, unsigned width, unsigned height)
+{
+    (void)width;
+    writeMonoCharLUTImpl(ctx, data, buffer, rowStride, 8, height, 1, 1);
+}
+
+/// Writes a whole character of a 16-pixel-wide font at scale 1 through the LUT.
+static void writeMonoCharLUT1W16(const WGFXmonoTextCtx *ctx, const WGFX_U8 *data,
+                                 WGFX_U8 *buffer, unsigned rowStride, unsigned width, unsigned height)
+{
+    (void)width;
+    writeMonoCharLUTImpl(ctx, data, buffer, rowStride, 16, height, 1, 2);
+}
+
+/// Writes a (possibly clipped) character of any width at scale 2 through the LUT.
+static void writeMonoCharLUT2(const WGFXmonoTextCtx *ctx, const WGFX_U8 *data,
+                              WGFX_U8 *buffer, unsigned rowStride, unsigned width, unsigned height)
+{
+    writeMonoCharLUTImpl(ctx, data, buffer, rowStride, width, height, 2, (ctx->font->width + 7) / 8);
+}
+
+/// Like `writeMonoCharLUT1()`/`writeMonoCharLUT2()`, but for `WGFX_FONT_PACKED` fonts (streaming bits across rows).
+static void writeMonoCharPackedLUT(const WGFXmonoTextCtx *ctx, const WGFX_U8 *data,
+                                   WGFX_U8 *buffer, unsigned rowStride, unsigned width, unsigned height)
+{
+    const unsigned bpp = ctx->bpp, scale = ctx->scale;
+    const unsigned entryBits = 4 / scale;
+    const unsigned fullEntries = width / 4, lastPixels = width % 4;
+    const unsigned lastBits = (lastPixels + scale - 1) / scale;
+    const unsigned skippedBits = ctx->font->width - (fullEntries * entryBits + lastBits);
+
+    WGFXbitReader reader;
+    initBitReader(&reader, data);
+    for(unsigned row = 0; row < height; row += scale)
+    {
+        WGFX_U8 *bufPtr = buffer;
+        for(unsigned i = 0; i < fullEntries; i++)
+        {
+            bufPtr = copyNibblePixels(bufPtr, &ctx->lut, readBits(&reader, entryBits), bpp, 4);
+        }
+        if(lastPixels != 0)
+        {
+            const unsigned entry = readBits(&reader, lastBits) << (entryBits - lastBits);
+            copyNibblePixels(bufPtr, &ctx->lut, entry, bpp, lastPixels);
+        }
+        skipBits(&reader, skippedBits);
+
+        if(scale == 1)
+        {
+            buffer += rowStride;
+        }
+        else
+        {
+            buffer = repeatRow(buffer, rowStride, width * bpp, MIN(scale, height - row));
+        }
+    }
+}
+
+#endif // WGFX_NO_GLYPH_LUT
+
+const WGFX_U8 *wgfxSparseGlyphData(const WGFXmonoFont *font, WGFX_U32 cp)
+{
+    // Binary search for the last range with `first <= cp`
+    unsigned lo = 0, hi = font->rangeCount;
+    WGFXglyphRange range;
+    while(lo < hi)
+    {
+        const unsigned mid = lo + (hi - lo) / 2;
+        WGFX_RODATA_MEMCPY(&range, &font->ranges[mid], sizeof(range));
+        if(range.first <= cp)
+        {
+            if(cp - range.first < range.count)
+            {
+                return font->data + ((WGFX_SIZET)range.firstGlyph + (cp - range.first)) * font->charDataStride;
+            }
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return 0;
+}
+
+/// Returns the first (up to 4) bytes of a `bpp`-bytes color as a 32-bit word, to be used as a glyph cache key.
+static WGFX_U32 colorKey(const WGFX_U8 *color, unsigned bpp)
+{
+    WGFX_U32 key = 0;
+    WGFX_MEMCPY(&key, color, MIN(bpp, 4));
+    return key;
+}
+
+#ifndef WGFX_NO_AA_FONTS
+/// Blends `fgColor` over `bgColor` with opacity `alpha` (0 to 255) to `dst` (that can be `bgColor`), through `ctx->blend`.
+static void blendShade(const WGFXmonoTextCtx *ctx, WGFX_U8 *dst, const WGFX_U8 *fgColor, const WGFX_U8 *bgColor,
+                       unsigned alpha)
+{
+    if(ctx->blend)
+    {
+        ctx->blend(dst, fgColor, bgColor, alpha, ctx->blendUserPtr);
+        return;
+    }
+    for(unsigned i = 0; i < ctx->bpp; i++)
+    {
+        dst[i] = (WGFX_U8)((fgColor[i] * alpha + bgColor[i] * (255 - alpha) + 127) / 255);
+    }
+}
+#endif
+
+/// Fills `ctx->shades` for `ctx->font`'s pixel values, blending the ones in between `bgColor` and `fgColor` (if any).
+static void initShades(WGFXmonoTextCtx *ctx)
+{
+    const unsigned maxValue = (1u << monoFontPixelBits(ctx->font)) - 1;
+    for(unsigned value = 0; value <= maxValue; value++)
+    {
+#ifndef WGFX_NO_AA_FONTS
+        if(value != 0 && value != maxValue && ctx->bgColor && ctx->bpp <= WGFX_MAX_BPP)
+        {
+            blendShade(ctx, ctx->shadeData[value], ctx->fgColor, ctx->bgColor, value * 255 / maxValue);
+            ctx->shades[value] = ctx->shadeData[value];
+            continue;
+        }
+#endif
+        // (colors too big for `shadeData` are not blended: pixels are either foreground or background)
+        ctx->shades[value] = (2 * value > maxValue) ? ctx->fgColor : ctx->bgColor;
+    }
+}
+
+/// Blends the 16-bit RGB565 color `fg` over `bg` with opacity `alpha` (0 to 255).
+static WGFX_U16 blendRGB565(WGFX_U16 fg, WGFX_U16 bg, unsigned alpha)
+{
+    // Spread the channels apart (green to the top half of the word), so that all three of them can be blended with a
+    // single multiplication each, at 5 bits of opacity
+    const WGFX_U32 alpha5 = (alpha + 4) >> 3;
+    const WGFX_U32 fgSpread = (fg | ((WGFX_U32)fg << 16)) & 0x07E0F81Fu, bgSpread = (bg | ((WGFX_U32)bg << 16)) & 0x07E0F81Fu;
+    const WGFX_U32 blended = ((fgSpread * alpha5 + bgSpread * (32 - alpha5) + 0x02008010u) >> 5) & 0x07E0F81Fu; //< (rounded)
+    return (WGFX_U16)(blended | (blended >> 16));
+}
+
+void wgfxBlendRGB565(WGFX_U8 *dst, const WGFX_U8 *fgColor, const WGFX_U8 *bgColor, unsigned alpha, void *userPtr)
+{
+    (void)userPtr;
+    const WGFX_U16 color = blendRGB565((WGFX_U16)((fgColor[0] << 8) | fgColor[1]), (WGFX_U16)((bgColor[0] << 8) | bgColor[1]), alpha);
+    dst[0] = (WGFX_U8)(color >> 8);
+    dst[1] = (WGFX_U8)color;
+}
+
+void wgfxBlendRGB565LE(WGFX_U8 *dst, const WGFX_U8 *fgColor, const WGFX_U8 *bgColor, unsigned alpha, void *userPtr)
+{
+    (void)userPtr;
+    const WGFX_U16 color = blendRGB565((WGFX_U16)((fgColor[1] << 8) | fgColor[0]), (WGFX_U16)((bgColor[1] << 8) | bgColor[0]), alpha);
+    dst[0] = (WGFX_U8)color;
+    dst[1] = (WGFX_U8)(color >> 8);
+}
+
+void wgfxInitMonoTextCtx(WGFXmonoTextCtx *ctx, const WGFXscreen *self, const WGFXmonoFont *font, unsigned scale,
+                         const WGFXcolor fgColor, const WGFXcolor bgColor)
+{
+    ctx->font = font;
+    ctx->bpp = self->bpp;
+    ctx->scale = scale;
+    ctx->charWidth = font->width * scale;
+    ctx->charHeight = font->height * scale;
+    ctx->fgColor = (const WGFX_U8 *)fgColor;
+    ctx->bgColor = (const WGFX_U8 *)bgColor;
+#ifndef WGFX_NO_AA_FONTS
+    ctx->blend = self->blend;
+    ctx->blendUserPtr = self->userPtr;
+#endif
+    initShades(ctx);
+
+    const int packed = font->flags & WGFX_FONT_PACKED;
+    const unsigned pixelBits = monoFontPixelBits(font);
+    (void)pixelBits; // (unused with both `WGFX_NO_AA_FONTS` and `WGFX_NO_GLYPH_LUT`)
+    ctx->writeChar = ctx->writeClippedChar = packed ? writeMonoCharPacked : writeMonoCharGeneric;
+#ifndef WGFX_NO_AA_FONTS
+    if(pixelBits > 1)
+    {
+        // Anti-aliased fonts are always drawn through `ctx->shades` (blended once above, instead of per pixel)
+        if(scale > 1 || packed)
+        {
+            ctx->writeChar = ctx->writeClippedChar = writeMonoCharAA;
+        }
+        else
+        {
+            ctx->writeChar = ctx->writeClippedChar = (pixelBits == 4) ? writeMonoCharAA4 : writeMonoCharAA2;
+        }
+    }
+#endif
+#ifndef WGFX_NO_GLYPH_LUT
+    if(pixelBits == 1 && bgColor && self->bpp <= WGFX_MAX_BPP && (scale == 1 || scale == 2))
+    {
+        // Expand fg/bg colors to a lookup table once, then use it for all characters
+        initNibbleLUT(&ctx->lut, ctx->fgColor, ctx->bgColor, self->bpp, scale);
+        if(packed)
+        {
+            ctx->writeChar = ctx->writeClippedChar = writeMonoCharPackedLUT;
+        }
+        else if(scale == 1)
+        {
+            ctx->writeClippedChar = writeMonoCharLUT1;
+            switch(font->width)
+            {
+            case 8:
+                ctx->writeChar = writeMonoCharLUT1W8;
+                break;
+            case 16:
+                ctx->writeChar = writeMonoCharLUT1W16;
+                break;
+            default:
+                ctx->writeChar = writeMonoCharLUT1;
+                break;
+            }
+        }
+        else
+        {
+            ctx->writeChar = ctx->writeClippedChar = writeMonoCharLUT2;
+        }
+    }
+#endif
+
+    WGFXglyphCache *const cache = self->glyphCache;
+    const int cacheable = cache && cache->slotCount > 0 && bgColor && self->bpp <= 4 && scale <= 0xFF
+                          && (WGFX_SIZET)ctx->charWidth * ctx->charHeight * self->bpp <= cache->slotSize;
+    ctx->cache = cacheable ? cache : 0;
+    ctx->fgKey = cacheable ? colorKey(ctx->fgColor, self->bpp) : 0;
+    ctx->bgKey = cacheable ? colorKey(ctx->bgColor, self->bpp) : 0;
+#ifndef WGFX_NO_AA_FONTS
+    ctx->blendKey = (cacheable && pixelBits > 1) ? self->blend : 0;
+#else
+    ctx->blendKey = 0;
+#endif
+}
+
+unsigned wgfxGlyphCacheInit(WGFXglyphCache *cache, void *arena, WGFX_SIZET arenaSize, WGFX_SIZET slotSize)
+{
+    // (keep slots' pixel data word-aligned, for faster copies)
+    slotSize = (slotSize + 3) & ~(WGFX_SIZET)3;
+    const WGFX_SIZET count = (slotSize > 0) ? arenaSize / (sizeof(WGFXglyphCacheSlot) + slotSize) : 0;
+
+    cache->slots = (WGFXglyphCacheSlot *)arena;
+    cache->pixels = (WGFX_U8 *)(cache->slots + count);
+    cache->slotCount = (unsigned)count;
+    cache->slotSize = slotSize;
+    cache->hits = cache->misses = 0;
+    wgfxGlyphCacheClear(cache);
+    return cache->slotCount;
+}
+
+void wgfxGlyphCacheClear(WGFXglyphCache *cache)
+{
+    for(unsigned i = 0; i < cache->slotCount; i++)
+    {
+        cache->slots[i].font = 0;
+        cache->slots[i].referenced = 0;
+    }
+    cache->hand = 0;
+}
+
+const WGFX_U8 *wgfxCachedGlyph(const WGFXmonoTextCtx *ctx, WGFX_U32 cp)
+{
+    WGFXglyphCache *const cache = ctx->cache;
+    for(unsigned i = 0; i < cache->slotCount; i++)
+    {
+        WGFXglyphCacheSlot *const slot = &cache->slots[i];
+        if(slot->font == ctx->font && slot->codepoint == cp && slot->fgKey == ctx->fgKey && slot->bgKey == ctx->bgKey
+           && slot->blend == ctx->blendKey && slot->scale == ctx->scale && slot->bpp == ctx->bpp)
+        {
+            slot->referenced = 1;
+            cache->hits++;
+            return cache->pixels + i * cache->slotSize;
+        }
+    }
+    cache->misses++;
+
+    // Evict the first slot not used since the clock hand last passed over it (empty slots are never referenced)
+    while(cache->slots[cache->hand].referenced)
+    {
+        cache->slots[cache->hand].referenced = 0;
+        cache->hand = (cache->hand + 1) % cache->slotCount;
+    }
+    const unsigned iSlot = cache->hand;
+    cache->hand = (cache->hand + 1) % cache->slotCount;
+
+    WGFXglyphCacheSlot *const slot = &cache->slots[iSlot];
+    slot->font = ctx->font;
+    slot->codepoint = cp;
+    slot->fgKey = ctx->fgKey;
+    slot->bgKey = ctx->bgKey;
+    slot->blend = ctx->blendKey;
+    slot->scale = (WGFX_U8)ctx->scale;
+    slot->bpp = (WGFX_U8)ctx->bpp;
+    slot->referenced = 1;
+
+    WGFX_U8 *const pixels = cache->pixels + iSlot * cache->slotSize;
+    const WGFX_U8 *const data = monoGlyphData(ctx->font, cp);
+    const unsigned rowStride = ctx->charWidth * ctx->bpp;
+    if(data)
+    {
+        ctx->writeChar(ctx, data, pixels, rowStride, ctx->charWidth, ctx->charHeight);
+    }
+    else
+    {
+        fillPixels(pixels, ctx->bgColor, ctx->bpp, (WGFX_SIZET)ctx->charWidth * ctx->charHeight);
+    }
+    return pixels;
+}
+
+void wgfxCompositeMonoChar(const WGFXmonoTextCtx *ctx, const WGFX_U8 *data, WGFX_U8 *buffer, unsigned rowStride,
+                           unsigned col0, unsigned nCols, unsigned row0, unsigned nRows, int transparent)
+{
+    const unsigned bpp = ctx->bpp, scale = ctx->scale;
+    if(!data)
+    {
+        for(unsigned row = 0; row < nRows && !transparent; row++)
+        {
+            fillPixels(buffer, ctx->bgColor, bpp, nCols);
+            buffer += rowStride;
+        }
+        return;
+    }
+
+    // (rows of packed fonts do not start on byte boundaries, so for them this only works from the top row)
+    const int packed = ctx->font->flags & WGFX_FONT_PACKED;
+    const unsigned pixelBits = monoFontPixelBits(ctx->font), maxValue = (1u << pixelBits) - 1;
+    if(!transparent && col0 == 0 && row0 % scale == 0 && (!packed || row0 == 0))
+    {
+        // Can use the (faster) character writers, skipping the rows at the top
+        const WGFX_U8 *const rowData = data + (row0 / scale) * ((ctx->font->width * pixelBits + 7) / 8);
+        if(nCols == ctx->charWidth)
+        {
+            ctx->writeChar(ctx, rowData, buffer, rowStride, nCols, nRows);
+        }
+        else
+        {
+            ctx->writeClippedChar(ctx, rowData, buffer, rowStride, nCols, nRows);
+        }
+        return;
+    }
+
+    const unsigned colEnd = col0 + nCols, rowEnd = row0 + nRows;
+    for(unsigned row = row0; row < rowEnd; row++)
+    {
+        WGFX_U8 *bufPtr = buffer;
+        for(unsigned col = col0; col < colEnd;)
+        {
+            // Draw the run of pixels that come from the same font pixel
+            const unsigned dataCol = col / scale;
+            const unsigned runEnd = MIN((dataCol + 1) * scale, colEnd);
+            const unsigned value = monoGlyphPixel(ctx->font, data, dataCol, row / scale);
+            WGFX_U8 *const runEndPtr = bufPtr + (runEnd - col) * bpp;
+            if(!transparent || value == maxValue)
+            {
+                fillPixels(bufPtr, ctx->shades[value], bpp, runEnd - col);
+            }
+#ifndef WGFX_NO_AA_FONTS
+            else if(value != 0)
+            {
+                // (an edge of a transparent anti-aliased character: blend it over what is already there)
+                for(WGFX_U8 *pixel = bufPtr; pixel < runEndPtr; pixel += bpp)
+                {
+                    blendShade(ctx, pixel, ctx->fgColor, pixel, value * 255 / maxValue);
+                }
+            }
+#endif
+            bufPtr = runEndPtr;
+            col = runEnd;
+        }
+        buffer += rowStride;
+    }
+}
+
+/// Writes the `w * h` pixels at `col0`, `row0` of `data` (whose rows are `rowStride` bytes apart) to the screen;
+/// all at once if they are contiguous, one row at a time otherwise.
+static void writePixelRect(WGFXscreen *self, const WGFX_U8 *data, WGFX_SIZET rowStride,
+                           unsigned col0, unsigned row0, unsigned w, unsigned h)
+{
+    const WGFX_SIZET rowSizeB = (WGFX_SIZET)w * self->bpp;
+    data += row0 * rowStride + (WGFX_SIZET)col0 * self->bpp;
+    if(rowSizeB == rowStride)
+    {
+        screenWrite(self, data, rowSizeB * h);
+        return;
+    }
+    for(unsigned row = 0; row < h; row++)
+    {
+        screenWrite(self, data, rowSizeB);
+        data += rowStride;
+    }
+}
+
+/// In `WGFX_SCREEN_MASK_TEXT` mode, 1 / this of the scratch buffer is used to expand the mask to `bpp` bytes per pixel.
+#define TEXT_MASK_EXPAND_DIVISOR 4
+
+/// The parts of the scratch buffer used in `WGFX_SCREEN_MASK_TEXT` mode.
+typedef struct
+{
+    /// The 1-bit mask characters are rendered to (MSB first, set bits = foreground), `maskSize` bytes.
+    WGFX_U8 *mask;
+    WGFX_SIZET maskSize;
+
+    /// Two buffers of `expandPixels` pixels each that the mask is expanded to, in turns, before being written to the screen.
+    WGFX_U8 *expand[2];
+    WGFX_SIZET expandPixels;
+    unsigned iExpand;
+} WGFXtextMask;
+
+/// Splits the scratch buffer for `WGFX_SCREEN_MASK_TEXT` mode. Returns false if it is too small.
+static int initTextMask(WGFXscreen *self, WGFXtextMask *tm)
+{
+    tm->expandPixels = (self->scratchSize / TEXT_MASK_EXPAND_DIVISOR) / 2;
+    if(tm->expandPixels == 0)
+    {
+        return 0;
+    }
+    // (the mask is rendered to regardless of the scratch halves: wait for the screen to be done with all of them)
+    screenWaitWrite(self, self->scratchData);
+    if(self->flags & WGFX_SCREEN_DOUBLE_BUFFER)
+    {
+        screenWaitWrite(self, self->scratchData + (self->scratchSize / 2) * self->bpp);
+    }
+    const WGFX_SIZET expandSizeB = tm->expandPixels * self->bpp;
+    tm->expand[0] = self->scratchData;
+    tm->expand[1] = self->scratchData + expandSizeB;
+    tm->iExpand = 0;
+    tm->mask = self->scratchData + 2 * expandSizeB;
+    tm->maskSize = self->scratchSize * self->bpp - 2 * expandSizeB;
+    return 1;
+}
+
+/// Renders the top-left `width * height` rectangle of codepoint `cp` (`scale`d) to the rows of a cleared 1-bit `mask`
+/// (`maskStride` bytes apart), starting from bit `bitX` of each. Characters missing from the font are left blank.
+static void writeMonoCharMask(const WGFXmonoFont *font, unsigned scale, WGFX_U32 cp, WGFX_U8 *mask, WGFX_SIZET maskStride,
+                              unsigned bitX, unsigned width, unsigned height)
+{
+    const WGFX_U8 *data = monoGlyphData(font, cp);
+    if(!data)
+    {
+        return;
+    }
+
+    if(scale == 1 && !(font->flags & WGFX_FONT_PACKED))
+    {
+        // Font rows are already 1-bit masks: shift them into place a byte at a time
+        const unsigned dataRowStride = (font->width + 7) / 8;
+        const unsigned shift = bitX % 8;
+        mask += bitX / 8;
+        for(unsigned row = 0; row < height; row++)
+        {
+            for(unsigned i = 0, col = 0; col < width; i++, col += 8)
+            {
+                unsigned byte = WGFX_RODATA_READU8(data + i);
+                if(width - col < 8)
+                {
+                    byte &= 0xFF << (8 - (width - col)); // (clipped)
+                }
+                mask[i] |= (WGFX_U8)(byte >> shift);
+                const WGFX_U8 spill = (WGFX_U8)(byte << (8 - shift));
+                if(shift != 0 && spill)
+                {
+                    mask[i + 1] |= spill; // (can only be set for bits that are still in the row)
+                }
+            }
+            data += dataRowStride;
+            mask += maskStride;
+        }
+        return;
+    }
+
+    for(unsigned row = 0; row < height; row++)
+    {
+        for(unsigned col = 0; col < width; col++)
+        {
+            if(monoGlyphPixel(font, data, col / scale, row / scale))
+            {
+                const unsigned bit = bitX + col;
+                mask[bit / 8] |= 0x80 >> (bit % 8);
+            }
+        }
+        mask += maskStride;
+    }
+}
+
+/// Expands `count` pixels of a row of a 1-bit mask, starting from column `col`, to `ctx->fgColor`/`ctx->bgColor` pixels.
+static void expandMaskPixels(const WGFXmonoTextCtx *ctx, WGFX_U8 *dst, const WGFX_U8 *maskRow, unsigned col, WGFX_SIZET count)
+{
+    const unsigned bpp = ctx->bpp;
+    while(count > 0)
+    {
+#ifndef WGFX_NO_GLYPH_LUT
+        if(bpp <= WGFX_MAX_BPP && col % 4 == 0 && count >= 4)
+        {
+            // A whole nibble at a time through the LUT
+            const unsigned nibble = (maskRow[col / 8] >> (4 - col % 8)) & 0xF;
+            dst = copyNibblePixels(dst, &ctx->lut, nibble, bpp, 4);
+            col += 4;
+            count -= 4;
+            continue;
+        }
+#endif
+        const int pixelOn = (maskRow[col / 8] << (col % 8)) & 0x80;
+        copyPixel(dst, pixelOn ? ctx->fgColor : ctx->bgColor, bpp);
+        dst += bpp;
+        col++;
+        count--;
+    }
+}
+
+/// Returns the next expand buffer of `tm`, waiting for the screen to be done reading from it if needed.
+inline static WGFX_U8 *acquireExpandBuffer(WGFXscreen *self, WGFXtextMask *tm)
+{
+    WGFX_U8 *const buf = tm->expand[tm->iExpand];
+    tm->iExpand = !tm->iExpand;
+    screenWaitWrite(self, buf);
+    return buf;
+}
 
-void wgfxFillRect(WGFXscreen *self, unsigned x, unsigned y, unsigned w, unsigned h, const WGFXcolor color)
+/// Expands the `w * h` pixels at `col0`, `row0` of the mask of `tm` (rows `maskStride` bytes apart) and writes them
+/// to the screen.
+static void writeTextMask(WGFXscreen *self, WGFXtextMask *tm, const WGFXmonoTextCtx *ctx, WGFX_SIZET maskStride,
+                          unsigned col0, unsigned row0, unsigned w, unsigned h)
+{
+    const unsigned bpp = self->bpp;
+    WGFX_U8 *buf = acquireExpandBuffer(self, tm);
+    WGFX_SIZET bufPixels = 0;
+    const WGFX_U8 *maskRow = tm->mask + row0 * maskStride;
+    for(unsigned row = 0; row < h; row++)
+    {
+        for(unsigned col = 0; col < w;)
+        {
+            const WGFX_SIZET n = MIN(w - col, tm->expandPixels - bufPixels);
+            expandMaskPixels(ctx, buf + bufPixels * bpp, maskRow, col0 + col, n);
+            bufPixels += n;
+            col += (unsigned)n;
+            if(bufPixels == tm->expandPixels)
+            {
+                screenWrite(self, buf, bufPixels * bpp);
+                buf = acquireExpandBuffer(self, tm);
+                bufPixels = 0;
+            }
+        }
+        maskRow += maskStride;
+    }
+    if(bufPixels > 0)
+    {
+        screenWrite(self, buf, bufPixels * bpp);
+    }
+}
+
+/// For the characters of a pre-rotated font: returns where the top-left pixel of character `iChar` of a line of `nChars`
+/// `charWidth * charHeight` characters goes in `buffer` (rows `rowStride` bytes apart), that stores the line rotated like
+/// the screen (see `rotateRect()`). There, the character is stored as drawn by the text context of the rotated font.
+static WGFX_U8 *rotatedCharPixels(const WGFXscreen *self, WGFX_U8 *buffer, unsigned rowStride, unsigned nChars,
+                                  unsigned iChar, unsigned charWidth, unsigned charHeight)
+{
+    unsigned x = iChar * charWidth, y = 0, w = charWidth, h = charHeight;
+    rotateRect(self->rotation, nChars * charWidth, charHeight, &x, &y, &w, &h);
+    return buffer + y * rowStride + x * self->bpp;
+}
+
+/// Implements `wgfxDrawTextMono()` (`utf8 = 0`) and `wgfxDrawTextMonoUTF8()` (`utf8 = 1`).
+static int drawTextMono(WGFXscreen *self, const char *string, unsigned length, unsigned *x, unsigned *y,
+                        const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor,
+                        WGFXwrapMode wrapMode, int utf8)
+{
+    const unsigned startX = *x, startY = *y;
+    scale = (scale > 1) ? scale : 1;
+    const unsigned charWidth = font->width * scale, charHeight = font->height * scale;
+
+    // Pre-rotated fonts can only be drawn on screens rotated the same way; their characters are then rendered as the
+    // screen stores them, a line's worth of the chunk at a time (chunks are as wide as the characters that are in them)
+    const WGFXrotation rotation = monoFontRotation(font);
+    if((rotation != WGFX_ROTATE_0 && rotation != self->rotation) || !monoFontSupported(font))
+    {
+        return 0;
+    }
+    const int rotated = rotation != WGFX_ROTATE_0;
+
+    // In `WGFX_SCREEN_MASK_TEXT` mode, characters are rendered to a 1-bit mask, expanded to `bpp` only when writing
+    // (that would lose the shades of anti-aliased fonts)
+    WGFXtextMask tm = {0};
+    const int useMask = !rotated && monoFontPixelBits(font) == 1 && (self->flags & WGFX_SCREEN_MASK_TEXT) && bgColor
+                        && initTextMask(self, &tm);
+
+    const unsigned pixelsPerChar = charWidth * charHeight;
+    const unsigned maxScratchChars = useMask ? (unsigned)((tm.maskSize / charHeight) * 8 / charWidth)
+                                             : (unsigned)(scratchPixels(self) / pixelsPerChar);
+    if(maxScratchChars == 0)
+    {
+        // Not enough memory to fit even one char
+        return 0;
+    }
+    const unsigned maxScratchWidth = maxScratchChars * charWidth;
+
+    unsigned lineWidth = 0, lineHeight = charHeight; // Width/height of scratch buffer rect for this line
+
+    // (in mask mode, `ctx` is only used to expand the mask, that already is scaled)
+    // (for pre-rotated fonts, `ctx` draws the rotated characters as they are stored: as the characters of an unrotated
+    // font, `height * width` for 90/270 degrees; the glyph cache is keyed by font, and that font is a temporary)
+    WGFXmonoFont rotatedFont;
+    if(rotated)
+    {
+        rotatedFont = *font;
+        rotatedFont.flags = (WGFXmonoFontFlags)(font->flags & ~WGFX_FONT_ROTATION_MASK);
+        if(rotation != WGFX_ROTATE_180)
+        {
+            rotatedFont.width = font->height;
+            rotatedFont.height = font->width;
+        }
+    }
+    WGFXmonoTextCtx ctx;
+    wgfxInitMonoTextCtx(&ctx, self, rotated ? &rotatedFont : font, useMask ? 1 : scale, fgColor, bgColor);
+    if(rotated)
+    {
+        ctx.cache = 0;
+    }
+
+    // In double-buffered mode, `endWrite()` for a chunk is deferred until the next chunk has been rendered
+    // to the other half of the scratch buffer, so that rendering overlaps with the previous chunk's transfer
+    const int deferEndWrite = self->flags & WGFX_SCREEN_DOUBLE_BUFFER;
+    int writePending = 0;
+
+    length = length == 0 ? stringLength(string) : length;
+    const char *const strEnd = string + length;
+    const char *iCh = string;
+    while(iCh < strEnd)
+    {
+        // Read entire line
+        const char *const lineStart = iCh;
+        WGFX_SIZET charsThisLine = 0;
+        while(iCh < strEnd && *iCh != '\n')
+        {
+            nextCodepoint(&iCh, strEnd, utf8);
+            charsThisLine++;
+        }
+        const char *const lineEnd = iCh;
+
+#ifndef WGFX_NO_CLIPPING
+        const unsigned nextLineY = *y + charHeight;
+
+        if(*y >= self->height)
+        {
+            // Line outside screen - exit
+            break;
+        }
+        else if(nextLineY >= self->height)
+        {
+            // Line only partially visible - clip
+            lineHeight = charHeight - (nextLineY - self->height);
+        }
+#endif
+
+        iCh = lineStart;
+        WGFX_SIZET charsDone = 0; // Characters of this line drawn so far
+
+        int lastCharClipped = 0; // Was the last character drawn cut off?
+        while(charsDone < charsThisLine)
+        {
+#ifndef WGFX_NO_CLIPPING
+            if(*x >= self->width)
+            {
+                if(wrapMode & WGFX_WRAP_RIGHT)
+                {
+                    // Reached the right screen edge; wrap and continue next line from `iCh`
+                    lastCharClipped = 1;
+                    *x = startX;
+                    *y += lineHeight;
+                }
+                else
+                {
+                    // This chunk of this line is offscreen; go to the next newline (if any)
+                    lastCharClipped = 0;
+                    iCh = lineEnd;
+                }
+                break;
+            }
+#endif
+
+            const unsigned nCharsThisChunk = MIN(maxScratchChars, charsThisLine - charsDone);
+            const unsigned maxChunkWidth = nCharsThisChunk * charWidth;       // Hypothetical maximum width for this chunk
+            const unsigned chunkWidth = MIN(maxChunkWidth, self->width - *x); // Actual width of this chunk
+            const unsigned chunkChars = (chunkWidth + charWidth - 1) / charWidth; // (including a clipped one)
+            unsigned chunkRowStride = useMask ? (chunkWidth + 7) / 8 : chunkWidth * self->bpp;
+            if(rotated)
+            {
+                // (clipped characters are rendered whole, and only the visible part of them is written)
+                chunkRowStride = ((rotation == WGFX_ROTATE_180) ? chunkChars * charWidth : charHeight) * self->bpp;
+            }
+
+            // The part of the chunk inside the clip rectangle; chunks outside of it are only laid out, not rendered
+            unsigned visX = *x, visY = *y, visW = chunkWidth, visH = lineHeight, visCol, visRow;
+            const int visible = clipRect(self, &visX, &visY, &visW, &visH, &visCol, &visRow);
+
+            WGFX_U8 *const chunkScratch = !visible ? 0 : useMask ? tm.mask : acquireScratch(self);
+            WGFX_U8 *chunkBuffer = chunkScratch;
+            if(visible && useMask)
+            {
+                WGFX_MEMSET(chunkScratch, 0, chunkRowStride * lineHeight); // (all background)
+            }
+
+            // Render as many whole characters as possible
+            unsigned xRight = 0; // End X of the last whole char, relative to scratch buffer X=0
+            const unsigned charStride = useMask ? 0 : charWidth * self->bpp; // Offset to go right to the top-left corner of next char
+            for(; xRight + charWidth <= chunkWidth; xRight += charWidth)
+            {
+                const WGFX_U32 cp = nextCodepoint(&iCh, strEnd, utf8);
+                if(!visible)
+                {
+                    charsDone++;
+                    continue;
+                }
+                if(useMask)
+                {
+                    writeMonoCharMask(font, scale, cp, chunkScratch, chunkRowStride, xRight, charWidth, lineHeight);
+                }
+                else if(rotated)
+                {
+                    writeMonoChar(&ctx, cp, rotatedCharPixels(self, chunkScratch, chunkRowStride, chunkChars, xRight / charWidth, charWidth, charHeight),
+                                  chunkRowStride, ctx.charWidth, ctx.charHeight);
+                }
+                else
+                {
+                    writeMonoChar(&ctx, cp, chunkBuffer, chunkRowStride, charWidth, lineHeight);
+                }
+                WGFX_STATS_ADD(self, glyphs, 1);
+                chunkBuffer += charStride;
+                charsDone++;
+            }
+
+            lastCharClipped = xRight < chunkWidth;
+            if(lastCharClipped)
+            {
+                // The next char would overshoot the end of the chunk (i.e. the right edge of the screen)
+                // -> need to draw a partially-clipped char or blank its area (depending on wrap mode)
+                const unsigned lastCharWidth = chunkWidth - xRight;
+
+                if(!(wrapMode & WGFX_WRAP_RIGHT))
+                {
+                    // Clip last character
+                    const WGFX_U32 cp = nextCodepoint(&iCh, strEnd, utf8);
+                    if(visible && useMask)
+                    {
+                        writeMonoCharMask(font, scale, cp, chunkScratch, chunkRowStride, xRight, lastCharWidth, lineHeight);
+                        WGFX_STATS_ADD(self, glyphs, 1);
+                    }
+                    else if(visible && rotated)
+                    {
+                        writeMonoChar(&ctx, cp, rotatedCharPixels(self, chunkScratch, chunkRowStride, chunkChars, chunkChars - 1, charWidth, charHeight),
+                                      chunkRowStride, ctx.charWidth, ctx.charHeight);
+                        WGFX_STATS_ADD(self, glyphs, 1);
+                    }
+                    else if(visible)
+                    {
+                        writeMonoChar(&ctx, cp, chunkBuffer, chunkRowStride, lastCharWidth, lineHeight);
+                        WGFX_STATS_ADD(self, glyphs, 1);
+                    }
+                    charsDone++;
+                    lastCharClipped = 0; // (no need to continue from it)
+                }
+                else
+                {
+                    // Wrap right: instead of drawing a partially clipped char at the end of the line, the character will
+                    // be drawn at the start of the next line.
+                    // Still need to fill the rectangle with `bgColor` to prevent artefacts! (the mask already is)
+                    if(visible && rotated)
+                    {
+                        chunkBuffer = rotatedCharPixels(self, chunkScratch, chunkRowStride, chunkChars, chunkChars - 1, charWidth, charHeight);
+                    }
+                    const unsigned blankWidth = rotated ? ctx.charWidth : lastCharWidth, blankHeight = rotated ? ctx.charHeight : lineHeight;
+                    for(unsigned iRow = 0; iRow < blankHeight && visible && !useMask; iRow++)
+                    {
+                        fillPixels(chunkBuffer, (const WGFX_U8 *)bgColor, self->bpp, blankWidth);
+                        chunkBuffer += chunkRowStride;
+                    }
+                }
+            }
+
+            // Draw the (visible part of the) scratch buffer to the screen when:
+            // - Scratch buffer full
+            // - '\n' reached
+            // - End of string reached
+            if(visible)
+            {
+                if(writePending)
+                {
+                    screenEndWrite(self);
+                }
+                if(rotated)
+                {
+                    // (the visible part of the chunk, as stored)
+                    unsigned col = visCol, row = visRow, w = visW, h = visH;
+                    rotateRect(rotation, chunkChars * charWidth, charHeight, &col, &row, &w, &h);
+                    screenBeginWriteRotated(self, visX, visY, visW, visH);
+                    writePixelRect(self, chunkScratch, chunkRowStride, col, row, w, h);
+                }
+                else if(useMask)
+                {
+                    screenBeginWrite(self, visX, visY, visW, visH);
+                    writeTextMask(self, &tm, &ctx, chunkRowStride, visCol, visRow, visW, visH);
+                }
+                else
+                {
+                    screenBeginWrite(self, visX, visY, visW, visH);
+                    screenReorderIntoScratch(self, chunkScratch, chunkRowStride * lineHeight);
+                    writePixelRect(self, chunkScratch, chunkRowStride, visCol, visRow, visW, visH);
+                }
+                if(deferEndWrite)
+                {
+                    writePending = 1;
+                }
+                else
+                {
+                    screenEndWrite(self);
+                }
+            }
+            *x += chunkWidth;
+
+            if(lastCharClipped && (wrapMode & WGFX_WRAP_RIGHT))
+            {
+                // Wrap and continue next line from `iCh`
+                *x = startX;
+                *y += lineHeight;
+                break;
+            }
+        }
+
+        if(iCh < strEnd && *iCh == '\n')
+        {
+            if(wrapMode & WGFX_WRAP_NEWLINE)
+            {
+                *x = startX;
+                *y += lineHeight;
+            }
+            else
+            {
+                // Need to draw the newline as a normal character
+                // FIXME IMPLEMENT!
+                //writeMonoChar('\n', charBuffer, self->bpp, charRowStride, font, font->width, font->height, fgColor, bgColor);
+                //self->writeRect(*x, *y, font->width, font->height, self->scratchData, self->userPtr);
+            }
+        }
+        if(!lastCharClipped)
+        {
+            iCh++; // Skip the '\n' or end char
+        }
+        // else continue next line from the clipped char
+    }
+
+    if(writePending)
+    {
+        screenEndWrite(self);
+    }
+    return 1;
+}
+
+int wgfxDrawTextMono(WGFXscreen *self, const char *string, unsigned length, unsigned *x, unsigned *y,
+                     const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor, WGFXwrapMode wrapMode)
+{
+    return drawTextMono(self, string, length, x, y, font, scale, fgColor, bgColor, wrapMode, 0);
+}
+
+int wgfxDrawTextMonoUTF8(WGFXscreen *self, const char *string, unsigned length, unsigned *x, unsigned *y,
+                         const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor, WGFXwrapMode wrapMode)
+{
+    return drawTextMono(self, string, length, x, y, font, scale, fgColor, bgColor, wrapMode, 1);
+}
+
+/// Draws a run of `length` characters of `string` on a single line, at `x`, `y` (for `wgfxUpdateTextMono()`).
+static int drawTextRun(WGFXscreen *self, const char *string, unsigned length, unsigned x, unsigned y,
+                       const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor)
+{
+    if(length == 0)
+    {
+        return 1;
+    }
+    return drawTextMono(self, string, length, &x, &y, font, scale, fgColor, bgColor, WGFX_WRAP_NONE, 0);
+}
+
+int wgfxUpdateTextMono(WGFXscreen *self, const char *oldString, const char *newString, unsigned length, unsigned x, unsigned y,
+                       const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor, WGFXwrapMode wrapMode)
+{
+    const unsigned oldLength = (length == 0) ? stringLength(oldString) : length;
+    length = (length == 0) ? stringLength(newString) : length;
+    scale = (scale > 1) ? scale : 1;
+    const unsigned charWidth = font->width * scale, charHeight = font->height * scale;
+
+    // If newlines moved, so did everything after them; just redraw the whole string in that case
+    for(unsigned i = 0; i < length; i++)
+    {
+        if((newString[i] == '\n') != (i < oldLength && oldString[i] == '\n'))
+        {
+            return drawTextMono(self, newString, length, &x, &y, font, scale, fgColor, bgColor, wrapMode, 0);
+        }
+    }
+
+    // Lay out characters like `wgfxDrawTextMono()` would, drawing each run of changed characters on a line at once
+    unsigned charX = x, charY = y;
+    unsigned runStart = 0, runLength = 0, runX = x, runY = y;
+    int ok = 1;
+    for(unsigned i = 0; i < length; i++)
+    {
+        if(newString[i] == '\n')
+        {
+            ok = drawTextRun(self, newString + runStart, runLength, runX, runY, font, scale, fgColor, bgColor) && ok;
+            runLength = 0;
+            if(wrapMode & WGFX_WRAP_NEWLINE)
+            {
+                charX = x;
+                charY += charHeight;
+            }
+            continue;
+        }
+        if((wrapMode & WGFX_WRAP_RIGHT) && charX + charWidth > self->width)
+        {
+            ok = drawTextRun(self, newString + runStart, runLength, runX, runY, font, scale, fgColor, bgColor) && ok;
+            runLength = 0;
+            if(x + charWidth > self->width)
+            {
+                break; // (not even one character fits in a line; `wgfxDrawTextMono()` would not draw any)
+            }
+            charX = x;
+            charY += charHeight;
+        }
+#ifndef WGFX_NO_CLIPPING
+        if(charY >= self->height)
+        {
+            break; // (all other characters are offscreen too)
+        }
+#endif
+
+        if(i >= oldLength || oldString[i] != newString[i])
+        {
+            if(runLength == 0)
+            {
+                runStart = i;
+                runX = charX;
+                runY = charY;
+            }
+            runLength++;
+        }
+        else
+        {
+            ok = drawTextRun(self, newString + runStart, runLength, runX, runY, font, scale, fgColor, bgColor) && ok;
+            runLength = 0;
+        }
+        charX += charWidth;
+    }
+    ok = drawTextRun(self, newString + runStart, runLength, runX, runY, font, scale, fgColor, bgColor) && ok;
+
+    return ok;
+}
+
+/// Finds the next line of text starting from `*iCh`, as laid out by `wgfxDrawTextBlockMono()`; `maxChars` is the
+/// maximum number of characters that fit in a line (only used if `wrapMode & WGFX_WRAP_RIGHT`).
+/// Returns the number of characters in the line (starting from the original `*iCh`) and advances `*iCh` to the
+/// start of the next line.
+static unsigned nextBlockLine(const char **iCh, const char *strEnd, unsigned maxChars, WGFXwrapMode wrapMode)
+{
+    const char *const lineStart = *iCh;
+    const char *lineEnd = lineStart;
+    while(lineEnd < strEnd && !(*lineEnd == '\n' && (wrapMode & WGFX_WRAP_NEWLINE)))
+    {
+        if((wrapMode & WGFX_WRAP_RIGHT) && (unsigned)(lineEnd - lineStart) == maxChars)
+        {
+            break;
+        }
+        lineEnd++;
+    }
+
+    *iCh = lineEnd;
+    if(*iCh < strEnd && **iCh == '\n' && (wrapMode & WGFX_WRAP_NEWLINE))
+    {
+        (*iCh)++; // Skip the '\n'
+    }
+    return (unsigned)(lineEnd - lineStart);
+}
+
+int wgfxDrawTextBlockMono(WGFXscreen *self, const char *string, unsigned length, unsigned *x, unsigned *y,
+                          const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor, WGFXwrapMode wrapMode)
 {
-    if(w == 0 || h == 0) return;
+    const unsigned startX = *x, startY = *y;
+    scale = (scale > 1) ? scale : 1;
+    const unsigned charWidth = font->width * scale, charHeight = font->height * scale;
 
-    const unsigned endX = x + w, endY = y + h;
+    length = (length == 0) ? stringLength(string) : length;
+    const char *const strEnd = string + length;
 
 #ifndef WGFX_NO_CLIPPING
-    if(x >= self->width) x = self->width - 1;
-    if(endX >= self->width) w = self->width - x;
-    if(y >= self->height) y = self->height - 1;
-    if(endY >= self->height) h = self->height - y;
+    if(startX >= self->width || startY >= self->height)
+    {
+        return 1; // Nothing to draw
+    }
+    const unsigned maxWidth = self->width - startX, maxHeight = self->height - startY;
+#else
+    const unsigned maxWidth = ~0u, maxHeight = ~0u;
 #endif
-
-    const WGFX_SIZET xferCount = w * h;
-    const WGFX_SIZET scratchSizeB = self->scratchSize * self->bpp;
-    const int rectFitsScratch = self->scratchSize >= xferCount;
-
-    const WGFX_SIZET fillCount = rectFitsScratch ? xferCount : self->scratchSize;
-    for(size_t i = 0, ib = 0; i < fillCount; i++, ib += self->bpp)
+    const unsigned maxChars = maxWidth / charWidth; // Max chars per line when wrapping right
+    if(((wrapMode & WGFX_WRAP_RIGHT) && maxChars == 0) || monoFontRotation(font) != WGFX_ROTATE_0
+       || !monoFontSupported(font))
     {
-        // TODO PERFORMANCE: Replace this memcpy with a for loop? (`bpp` will always be small)
-        WGFX_MEMCPY(&self->scratchData[ib], color, self->bpp);
+        // (pre-rotated fonts are only drawn line by line; `wgfxDrawTextMono()` fails for unsupported ones)
+        return wgfxDrawTextMono(self, string, length, x, y, font, scale, fgColor, bgColor, wrapMode);
     }
 
-    self->beginWrite(x, y, w, h, self->userPtr);
-    if(rectFitsScratch)
+    // Measure the window: the longest (visible) line and the (visible) number of lines
+    unsigned blockChars = 0, nLines = 0, lastLineChars = 0;
+    for(const char *iCh = string; iCh < strEnd && nLines * charHeight < maxHeight;)
     {
-        // Fill whole rect at once
-        self->write(self->scratchData, xferCount * self->bpp, self->userPtr);
+        lastLineChars = nextBlockLine(&iCh, strEnd, maxChars, wrapMode);
+        blockChars = MAX(blockChars, lastLineChars);
+        nLines++;
     }
-    else
+    if(blockChars == 0)
     {
-        // Fill rect in chunks
-        const WGFX_SIZET xferSizeB = xferCount * self->bpp;
-        WGFX_SIZET chunkSizeB = scratchSizeB;
-        for(WGFX_SIZET sentB = 0; sentB < xferSizeB; sentB += chunkSizeB)
-        {
-            self->write(self->scratchData, chunkSizeB, self->userPtr);
-            chunkSizeB = MIN(chunkSizeB, xferSizeB - sentB);
-        }
+        return 1; // Nothing to draw
     }
-    self->endWrite(self->userPtr);
-}
+    const unsigned blockWidth = MIN(blockChars * charWidth, maxWidth);
+    const unsigned blockHeight = MIN(nLines * charHeight, maxHeight);
+    const unsigned endX = startX + MIN(lastLineChars * charWidth, blockWidth), endY = startY + (nLines - 1) * charHeight;
 
-/// <string.h>-less strlen
-inline static unsigned stringLength(const char *string)
-{
-    const char *iCh = string;
-    while(*iCh)
+    // Only the part of the window inside the clip rectangle is sent
+    unsigned visX = startX, visY = startY, visW = blockWidth, visH = blockHeight, visCol, visRow;
+    if(!clipRect(self, &visX, &visY, &visW, &visH, &visCol, &visRow))
     {
-        iCh++;
+        *x = endX;
+        *y = endY;
+        return 1;
     }
-    return (unsigned)(iCh - string);
-}
 
-/// Renders a `width * height` rectangle of a `font` character to a data `buffer`,
-/// scaled by `scale`, and with given foreground and background colors.
-/// Note that `the `width` and `height` passed to this function are expected to be scaled by `scale` as needed.
-/// `rowStride` is the offset in bytes between rows of `buffer`.
-///
-/// Returns the pointer into `buffer` at the character's bottom-right corner.
-/// Does NOT even try to perform any clipping or bounds checking!
-WGFX_FORCEINLINE static WGFX_U8 *writeMonoChar(
-    char ch,
-    WGFX_U8 *buffer, unsigned bpp, unsigned rowStride,
-    const WGFXmonoFont *font, unsigned scale, unsigned width, unsigned height,
-    const WGFXcolor fgColor, const WGFXcolor bgColor)
-{
-    WGFX_U8 *bufPtr = buffer;
-    const int hasChar = font->firstChar <= ch && ch <= font->lastChar;
-    if(hasChar)
+    const unsigned linesPerChunk = scratchPixels(self) / ((WGFX_SIZET)blockWidth * charHeight);
+    if(linesPerChunk == 0)
     {
-        const WGFX_U8 *data = font->data + ((WGFX_SIZET)(ch - font->firstChar) * font->charDataStride);
-        WGFX_U8 dataByte;
-        unsigned dataByteBit = 0; // Which bit into the current data byte
-
-        const unsigned charRowStride = width * bpp; // Length in bytes of a character row
+        return wgfxDrawTextMono(self, string, length, x, y, font, scale, fgColor, bgColor, wrapMode);
+    }
 
-        for(unsigned row = 0; row < height; row += scale)
-        {
-            dataByte = WGFX_RODATA_READU8(data);
-            dataByteBit = 0;
-            bufPtr = buffer;
+    WGFXmonoTextCtx ctx;
+    wgfxInitMonoTextCtx(&ctx, self, font, scale, fgColor, bgColor);
 
-            unsigned col = 0;
-            for(unsigned dataBit = 0; dataBit < font->width; dataBit++)
-            {
-                // Draw pixels only up to `width`, but seek in the memory buffer up to `font->width`!
-                if(col < width)
-                {
-                    const int pixelOn = dataByte & 0x80;
-                    dataByte <<= 1;
+    const unsigned rowStride = blockWidth * self->bpp;
+    const unsigned charStride = charWidth * self->bpp;
 
-                    for(unsigned i = 0; i < scale; i++) //< (to upscale horizontally)
-                    {
-                        // TODO PERFORMANCE: Replace memcpy with a simple for loop?
-                        // TODO PERFORMANCE: Replace the ternary operator with something else?
-                        WGFX_MEMCPY(bufPtr, pixelOn ? fgColor : bgColor, bpp);
-                        bufPtr += bpp;
-                    }
-                }
-                col += scale;
+    screenBeginWrite(self, visX, visY, visW, visH);
 
-                // (the sequence below should be slightly faster than using `dataByteBit % 8`)
-                dataByteBit++;
-                if(dataByteBit == 8)
-                {
-                    data++;
-                    dataByte = WGFX_RODATA_READU8(data);
-                    dataByteBit = 0;
-                }
-            }
+    const char *iCh = string;
+    unsigned lineY = 0; // Y of the current line, relative to `startY`
+    for(unsigned iLine = 0; iLine < nLines;)
+    {
+        // Render as many lines as will fit in the scratch buffer, then write them out all at once
+        const unsigned chunkY = lineY;
+        WGFX_U8 *const chunkScratch = acquireScratch(self);
+        WGFX_U8 *lineBuffer = chunkScratch;
+        for(unsigned i = 0; i < linesPerChunk && iLine < nLines; i++, iLine++)
+        {
+            const char *lineCh = iCh;
+            const unsigned lineChars = nextBlockLine(&iCh, strEnd, maxChars, wrapMode);
+            const unsigned lineHeight = MIN(charHeight, blockHeight - lineY);
 
-            if(dataByteBit != 0)
+            WGFX_U8 *bufPtr = lineBuffer;
+            unsigned xRight = 0;
+            for(unsigned iChar = 0; iChar < lineChars && xRight < blockWidth; iChar++)
             {
-                data++; // Skip trailing zeroes for the byte
+                const unsigned width = MIN(charWidth, blockWidth - xRight);
+                writeMonoChar(&ctx, (unsigned char)*lineCh++, bufPtr, rowStride, width, lineHeight);
+                WGFX_STATS_ADD(self, glyphs, 1);
+                bufPtr += charStride;
+                xRight += width;
             }
-            buffer += rowStride; // End of row
-
-            for(unsigned i = 1; i < scale; i++) //< (to upscale vertically)
+            if(xRight < blockWidth)
             {
-                WGFX_MEMCPY(buffer, buffer - rowStride, charRowStride);
-                buffer += rowStride; // End of row
+                // Pad the line to the width of the window
+                for(unsigned iRow = 0; iRow < lineHeight; iRow++)
+                {
+                    fillPixels(lineBuffer + xRight * self->bpp + iRow * rowStride, ctx.bgColor, self->bpp, blockWidth - xRight);
+                }
             }
+
+            lineBuffer += lineHeight * rowStride;
+            lineY += lineHeight;
         }
-    }
-    else
-    {
-        for(unsigned row = 0; row < height; row++)
+
+        const unsigned row0 = MAX(chunkY, visRow), row1 = MIN(lineY, visRow + visH);
+        if(row0 < row1)
         {
-            bufPtr = buffer;
-            for(unsigned col = 0; col < width; col++)
-            {
-                // TODO PERFORMANCE: Replace memcpy with a simple for loop?
-                WGFX_MEMCPY(bufPtr, bgColor, bpp);
-                bufPtr += bpp;
-            }
-            buffer += rowStride;
+            writePixelRect(self, chunkScratch, rowStride, visCol, row0 - chunkY, visW, row1 - row0);
         }
     }
 
-    return buffer;
+    screenEndWrite(self);
+
+    *x = endX;
+    *y = endY;
+    return 1;
 }
 
-int wgfxDrawTextMono(WGFXscreen *self, const char *string, unsigned length, unsigned *x, unsigned *y,
-                     const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor, WGFXwrapMode wrapMode)
+/// State of a decoder of `WGFX_BITMAP_RLE` bitmap data.
+typedef struct
 {
-    const unsigned startX = *x, startY = *y;
-    scale = (scale > 1) ? scale : 1;
-    const unsigned charWidth = font->width * scale, charHeight = font->height * scale;
+    const WGFX_U8 *src; ///< The next byte of encoded data.
+    unsigned bpp;
+    int rodata;         ///< Is `src` in `WGFX_RODATA`?
+    unsigned left;      ///< Pixels left in the current packet.
+    int run;            ///< Is the current packet a run (or a literal)?
+} WGFXrleDecoder;
 
-    const unsigned pixelsPerChar = charWidth * charHeight;
-    const unsigned maxScratchChars = self->scratchSize / pixelsPerChar;
-    if(maxScratchChars == 0)
+inline static void rleCopy(const WGFXrleDecoder *dec, WGFX_U8 *dst, WGFX_SIZET size)
+{
+    if(dec->rodata)
     {
-        // Not enough memory to fit even one char
-        return 0;
+        WGFX_RODATA_MEMCPY(dst, dec->src, size);
     }
-    const unsigned maxScratchWidth = maxScratchChars * charWidth;
+    else
+    {
+        WGFX_MEMCPY(dst, dec->src, size);
+    }
+}
 
-    unsigned lineWidth = 0, lineHeight = charHeight; // Width/height of scratch buffer rect for this line
+/// Loads the header of the next packet if the current one is over.
+WGFX_FORCEINLINE static void rleNextPacket(WGFXrleDecoder *dec)
+{
+    if(dec->left == 0)
+    {
+        const unsigned header = dec->rodata ? WGFX_RODATA_READU8(dec->src) : *dec->src;
+        dec->src++;
+        dec->run = header & 0x80;
+        dec->left = (header & 0x7F) + 1;
+    }
+}
 
-    length = length == 0 ? stringLength(string) : length;
-    const char *const strEnd = string + length;
-    const char *iCh = string;
-    while(iCh < strEnd)
+/// Decodes the next `count` pixels to `dst`.
+static void rleDecode(WGFXrleDecoder *dec, WGFX_U8 *dst, WGFX_SIZET count)
+{
+    const unsigned bpp = dec->bpp;
+    while(count > 0)
     {
-        // Read entire line
-        const char *const lineStart = iCh;
-        while(*iCh != '\n' && iCh < strEnd)
+        rleNextPacket(dec);
+        const unsigned n = (unsigned)MIN(count, dec->left);
+        if(dec->run)
         {
-            iCh++;
+            // Load the run's pixel once, then repeat it from memory
+            rleCopy(dec, dst, bpp);
+            fillPixels(dst + bpp, dst, bpp, n - 1);
         }
-        const char *const lineEnd = iCh;
-        const WGFX_SIZET charsThisLine = lineEnd - lineStart;
-
-#ifndef WGFX_NO_CLIPPING
-        const unsigned nextLineY = *y + charHeight;
+        else
+        {
+            rleCopy(dec, dst, n * bpp);
+            dec->src += n * bpp;
+        }
+        dec->left -= n;
+        if(dec->run && dec->left == 0)
+        {
+            dec->src += bpp; // (end of the run)
+        }
+        dst += n * bpp;
+        count -= n;
+    }
+}
 
-        if(*y >= self->height)
+/// Skips the next `count` pixels.
+static void rleSkip(WGFXrleDecoder *dec, WGFX_SIZET count)
+{
+    while(count > 0)
+    {
+        rleNextPacket(dec);
+        const unsigned n = (unsigned)MIN(count, dec->left);
+        dec->left -= n;
+        if(!dec->run)
         {
-            // Line outside screen - exit
-            return 1;
+            dec->src += n * dec->bpp;
         }
-        else if(nextLineY >= self->height)
+        else if(dec->left == 0)
         {
-            // Line only partially visible - clip
-            lineHeight = charHeight - (nextLineY - self->height);
+            dec->src += dec->bpp;
         }
-#endif
+        count -= n;
+    }
+}
 
-        iCh = lineStart;
+/// Draws the `w * h` pixels at `srcX`, `srcY` of a `WGFX_BITMAP_RLE` `imgW`-wide image at `x`, `y` (already clipped).
+static void drawBitmapRLE(WGFXscreen *self, const WGFX_U8 *image, unsigned imgW, unsigned srcX, unsigned srcY,
+                          unsigned x, unsigned y, unsigned w, unsigned h, int rodata)
+{
+    WGFXrleDecoder dec;
+    dec.src = image;
+    dec.bpp = self->bpp;
+    dec.rodata = rodata;
+    dec.left = 0;
+    dec.run = 0;
 
-        const unsigned nChunks = (charsThisLine - 1) / maxScratchChars + 1;
-        int lastCharClipped = 0; // Was the last character drawn cut off?
-        for(unsigned i = 0; i < nChunks; i++)
+    const WGFX_SIZET maxChunkPixels = scratchPixels(self);
+    if(maxChunkPixels == 0)
+    {
+        return;
+    }
+
+    rleSkip(&dec, (WGFX_SIZET)srcY * imgW + srcX); // (clipped on the top and left)
+
+    screenBeginWrite(self, x, y, w, h);
+
+    // Decode rows into the scratch buffer back-to-back, writing it whenever it gets full
+    WGFX_U8 *chunk = acquireScratch(self);
+    WGFX_SIZET chunkPixels = 0;
+    for(unsigned row = 0; row < h; row++)
+    {
+        for(WGFX_SIZET rowLeft = w; rowLeft > 0;)
         {
-#ifndef WGFX_NO_CLIPPING
-            if(*x >= self->width && (wrapMode & WGFX_WRAP_NEWLINE))
+            const WGFX_SIZET n = MIN(rowLeft, maxChunkPixels - chunkPixels);
+            rleDecode(&dec, chunk + chunkPixels * self->bpp, n);
+            chunkPixels += n;
+            rowLeft -= n;
+            if(chunkPixels == maxChunkPixels)
             {
-                // This chunk of this line is offscreen; go to the next newline (if any)
-                lastCharClipped = 0;
-                iCh = lineEnd;
-                break;
+                screenWrite(self, chunk, chunkPixels * self->bpp);
+                chunk = acquireScratch(self);
+                chunkPixels = 0;
             }
-#endif
+        }
+        if(row + 1 < h)
+        {
+            rleSkip(&dec, imgW - w); // (clipped on the right, and on the left of the next row)
+        }
+    }
+    if(chunkPixels > 0)
+    {
+        screenWrite(self, chunk, chunkPixels * self->bpp);
+    }
 
-            WGFX_U8 *chunkBuffer = self->scratchData;
-            const unsigned nCharsThisChunk = MIN(maxScratchChars, charsThisLine - (iCh - lineStart));
-            const unsigned maxChunkWidth = nCharsThisChunk * charWidth;       // Hypothetical maximum width for this chunk
-            const unsigned chunkWidth = MIN(maxChunkWidth, self->width - *x); // Actual width of this chunk
-            const unsigned chunkRowStride = chunkWidth * self->bpp;
+    screenEndWrite(self);
+}
 
-            // Render as many whole characters as possible
-            unsigned xRight = 0; // End X of the current char, relative to scratch buffer X=0
-            if(chunkWidth >= charWidth)
-            {
-                const unsigned charStride = charWidth * self->bpp; // Offset to go right to the top-left corner of next char
+void wgfxDrawBitmap(WGFXscreen *self, const WGFX_U8 *image, unsigned imgW, unsigned imgH,
+                    unsigned x, unsigned y, unsigned w, unsigned h, WGFXbitmapFlags flags)
+{
+    w = MIN(imgW, w);
+    h = MIN(imgH, h);
 
-                for(; xRight < chunkWidth; xRight += charWidth)
-                {
-                    writeMonoChar(*iCh, chunkBuffer, self->bpp, chunkRowStride, font, scale, charWidth, lineHeight, fgColor, bgColor);
-                    chunkBuffer += charStride;
-                    iCh++;
-                }
-            }
+    if(!(flags & WGFX_BITMAP_RLE))
+    {
+        wgfxDrawBitmapRegion(self, image, imgW * self->bpp, 0, 0, x, y, w, h, flags);
+        return;
+    }
 
-            lastCharClipped = xRight > chunkWidth || xRight == 0;
-            if(lastCharClipped)
-            {
-                // Either the last char's end X overshoot the end of the chunk,
-                // or we couldn't fit any character in it
-                // -> need to draw a partially-clipped char or blank its area (depending on wrap mode)
-                const unsigned lastCharWidth = chunkWidth - (xRight - charWidth);
+    unsigned srcX, srcY;
+    if(!clipRect(self, &x, &y, &w, &h, &srcX, &srcY))
+    {
+        return;
+    }
+    drawBitmapRLE(self, image, imgW, srcX, srcY, x, y, w, h, flags & WGFX_BITMAP_RODATA);
+}
 
-                if(!(wrapMode & WGFX_WRAP_RIGHT))
+/// Draws the `w * h` region of an image at `image` (its top-left pixel; rows `imgStride` bytes apart) to `x`, `y` of a
+/// rotated screen: copies it to the scratch buffer in the order the screen stores pixels in, as many stored rows at a
+/// time as fit. Returns false if not even one of them fits.
+static int drawRotatedBitmapRegion(WGFXscreen *self, const WGFX_U8 *image, WGFX_SIZET imgStride,
+                                   unsigned x, unsigned y, unsigned w, unsigned h, int rodata)
+{
+    const unsigned bpp = self->bpp;
+    unsigned px = x, py = y, pw = w, ph = h;
+    rotateRect(self->rotation, self->width, self->height, &px, &py, &pw, &ph);
+    const unsigned rowsPerChunk = (unsigned)MIN(scratchPixels(self) / pw, ph);
+    if(rowsPerChunk == 0)
+    {
+        return 0;
+    }
+
+    screenBeginWriteRotated(self, x, y, w, h);
+    for(unsigned row = 0; row < ph;)
+    {
+        const unsigned nRows = MIN(rowsPerChunk, ph - row);
+        WGFX_U8 *const chunk = acquireScratch(self);
+        WGFX_U8 *dst = chunk;
+        for(unsigned i = 0; i < nRows; i++)
+        {
+            long step;
+            const WGFX_U8 *const src = rotatedRow(self->rotation, image, imgStride, bpp, w, h, row + i, &step);
+            for(unsigned j = 0; j < pw; j++)
+            {
+                if(rodata)
                 {
-                    // Clip last character
-                    writeMonoChar(*iCh, chunkBuffer, self->bpp, chunkRowStride, font, scale, lastCharWidth, lineHeight, fgColor, bgColor);
-                    iCh++;
+                    WGFX_RODATA_MEMCPY(dst, src + (long)j * step, bpp);
                 }
                 else
                 {
-                    // Wrap right: instead of drawing a partially clipped char at the end of the line, the character will
-                    // be drawn at the start of the next line.
-                    // Still need to fill the rectangle with `bgColor` to prevent artefacts!
-                    for(unsigned iRow = 0; iRow < lineHeight; iRow++)
-                    {
-                        WGFX_U8 *bufPtr = chunkBuffer;
-                        for(unsigned iCol = 0; iCol < lastCharWidth; iCol++)
-                        {
-                            // TODO: Replace the memcpy with a simple for loop for performance?
-                            WGFX_MEMCPY(bufPtr, bgColor, self->bpp);
-                            bufPtr += self->bpp;
-                        }
-                        chunkBuffer += chunkRowStride;
-                    }
+                    copyPixel(dst, src + (long)j * step, bpp);
                 }
+                dst += bpp;
             }
+        }
+        screenWrite(self, chunk, (WGFX_SIZET)nRows * pw * bpp);
+        row += nRows;
+    }
+    screenEndWrite(self);
+    return 1;
+}
 
-            // Draw the whole scratch buffer to the screen when:
-            // - Scratch buffer full
-            // - '\n' reached
-            // - End of string reached
-            self->beginWrite(*x, *y, chunkWidth, lineHeight, self->userPtr);
-            self->write(self->scratchData, chunkWidth * lineHeight * self->bpp, self->userPtr);
-            self->endWrite(self->userPtr);
-            *x += chunkWidth;
+void wgfxDrawBitmapRegion(WGFXscreen *self, const WGFX_U8 *image, WGFX_SIZET imgStride, unsigned srcX, unsigned srcY,
+                          unsigned x, unsigned y, unsigned w, unsigned h, WGFXbitmapFlags flags)
+{
+    unsigned dx, dy;
+    if(!clipRect(self, &x, &y, &w, &h, &dx, &dy) || (flags & WGFX_BITMAP_RLE))
+    {
+        return;
+    }
+    srcX += dx;
+    srcY += dy;
 
-            if(lastCharClipped && (wrapMode & WGFX_WRAP_RIGHT))
-            {
-                // Wrap and continue next line from `iCh`
-                *x = startX;
-                *y += lineHeight;
-                break;
-            }
-        }
+    const unsigned bpp = self->bpp;
+    const WGFX_SIZET rowSizeB = (WGFX_SIZET)w * bpp;
+    const WGFX_SIZET scratchSizeB = scratchPixels(self) * bpp;
+    const int rodata = flags & WGFX_BITMAP_RODATA;
+    if(rodata && scratchSizeB == 0)
+    {
+        return;
+    }
+
+    image += (WGFX_SIZET)srcY * imgStride + (WGFX_SIZET)srcX * bpp;
+
+    if(self->rotation != WGFX_ROTATE_0 && drawRotatedBitmapRegion(self, image, imgStride, x, y, w, h, rodata))
+    {
+        return;
+    }
+    screenBeginWrite(self, x, y, w, h);
 
-        if(*iCh == '\n')
+    if(!rodata)
+    {
+        if(imgStride == rowSizeB)
         {
-            if(wrapMode & WGFX_WRAP_NEWLINE)
+            // Rows are contiguous: can write the whole region at once directly
+            screenWrite(self, image, rowSizeB * h);
+        }
+        else
+        {
+            for(unsigned row = 0; row < h; row++)
             {
-                *x = startX;
-                *y += lineHeight;
+                screenWrite(self, image, rowSizeB);
+                image += imgStride;
             }
-            else
+        }
+    }
+    else if(rowSizeB <= scratchSizeB)
+    {
+        // Load as many whole rows as fit in the scratch buffer at a time
+        // (in double-buffered mode, the next chunk is loaded while the previous one is being written)
+        const unsigned rowsPerChunk = (unsigned)(scratchSizeB / rowSizeB);
+        for(unsigned row = 0; row < h;)
+        {
+            const unsigned nRows = MIN(rowsPerChunk, h - row);
+            WGFX_U8 *const chunk = acquireScratch(self);
+            for(unsigned i = 0; i < nRows; i++)
             {
-                // Need to draw the newline as a normal character
-                // FIXME IMPLEMENT!
-                //writeMonoChar('\n', charBuffer, self->bpp, charRowStride, font, font->width, font->height, fgColor, bgColor);
-                //self->writeRect(*x, *y, font->width, font->height, self->scratchData, self->userPtr);
+                WGFX_RODATA_MEMCPY(chunk + i * rowSizeB, image, rowSizeB);
+                image += imgStride;
             }
+            screenWrite(self, chunk, nRows * rowSizeB);
+            row += nRows;
         }
-        if(!lastCharClipped)
+    }
+    else
+    {
+        // Rows do not fit in the scratch buffer: load each in multiple chunks
+        for(unsigned row = 0; row < h; row++)
         {
-            iCh++; // Skip the '\n' or end char
+            for(WGFX_SIZET iByte = 0; iByte < rowSizeB;)
+            {
+                const WGFX_SIZET chunkSizeB = MIN(scratchSizeB, rowSizeB - iByte);
+                WGFX_U8 *const chunk = acquireScratch(self);
+                WGFX_RODATA_MEMCPY(chunk, image + iByte, chunkSizeB);
+                screenWrite(self, chunk, chunkSizeB);
+                iByte += chunkSizeB;
+            }
+            image += imgStride;
         }
-        // else continue next line from the clipped char
     }
 
-    return 1;
+    screenEndWrite(self);
 }
 
-void wgfxDrawBitmap(WGFXscreen *self, const WGFX_U8 *image, unsigned imgW, unsigned imgH,
-                    unsigned x, unsigned y, unsigned w, unsigned h, WGFXbitmapFlags flags)
+/// Expands `count` pixels of a row of `wgfxDrawIndexedBitmap()` data, starting from column `col`, to `dst`.
+/// If not null, `lut` must map the bits of 1-bit indices to the palette.
+static void expandIndexedPixels(WGFX_U8 *dst, const WGFX_U8 *rowData, unsigned indexBits, const WGFXcolor *palette,
+                                const void *lut, unsigned bpp, int rodata, unsigned col, unsigned count)
 {
-    w = MIN(imgW, w);
-    h = MIN(imgH, h);
-    const unsigned endX = x + w, endY = y + h;
-
-#ifndef WGFX_NO_CLIPPING
-    if(x >= self->width)
-    {
-        return;
-    }
-    else if(endX >= self->width)
+    const unsigned indexMask = (1u << indexBits) - 1;
+    const unsigned colEnd = col + count;
+    while(col < colEnd)
     {
-        w = self->width - x;
+        const WGFX_U8 *const bytePtr = rowData + (col * indexBits) / 8;
+        const unsigned byte = rodata ? WGFX_RODATA_READU8(bytePtr) : *bytePtr;
+#ifndef WGFX_NO_GLYPH_LUT
+        if(lut && (col & 0x3) == 0 && colEnd - col >= 4)
+        {
+            // 4 1-bit indices at once through the lookup table
+            dst = copyNibblePixels(dst, (const WGFXnibbleLUT *)lut, (byte >> (4 - (col & 0x4))) & 0xF, bpp, 4);
+            col += 4;
+            continue;
+        }
+#else
+        (void)lut;
+#endif
+        const unsigned shift = 8 - indexBits - (col * indexBits) % 8;
+        copyPixel(dst, (const WGFX_U8 *)palette[(byte >> shift) & indexMask], bpp);
+        dst += bpp;
+        col++;
     }
+}
 
-    if(y >= self->height)
+void wgfxDrawIndexedBitmap(WGFXscreen *self, const WGFX_U8 *image, unsigned indexBits, const WGFXcolor *palette,
+                           unsigned imgW, unsigned imgH, unsigned x, unsigned y, unsigned w, unsigned h,
+                           WGFXbitmapFlags flags)
+{
+    if(indexBits != 1 && indexBits != 2 && indexBits != 4 && indexBits != 8)
     {
         return;
     }
-    else if(endY >= self->height)
+
+    w = MIN(imgW, w);
+    h = MIN(imgH, h);
+    unsigned srcX, srcY;
+    const WGFX_SIZET maxChunkPixels = scratchPixels(self);
+    if(!clipRect(self, &x, &y, &w, &h, &srcX, &srcY) || maxChunkPixels == 0)
     {
-        h = self->height - y;
+        return;
     }
-#endif
 
     const int rodata = flags & WGFX_BITMAP_RODATA;
-    const WGFX_SIZET scratchSizeB = self->scratchSize * self->bpp;
-    const WGFX_SIZET rectSize = w * h, rectSizeB = rectSize * self->bpp;
+    const WGFX_SIZET imageRowStride = ((WGFX_SIZET)imgW * indexBits + 7) / 8;
+    image += srcY * imageRowStride;
 
-    self->beginWrite(x, y, w, h, self->userPtr);
-
-    if(!rodata && w == imgW && h == imgH)
+    const void *lut = 0;
+#ifndef WGFX_NO_GLYPH_LUT
+    WGFXnibbleLUT lutStorage;
+    if(indexBits == 1 && self->bpp <= WGFX_MAX_BPP)
     {
-        // Can write the whole image at once directly
-        self->write(image, rectSize, self->userPtr);
+        initNibbleLUT(&lutStorage, (const WGFX_U8 *)palette[1], (const WGFX_U8 *)palette[0], self->bpp, 1);
+        lut = &lutStorage;
     }
-    else
+#endif
+
+    screenBeginWrite(self, x, y, w, h);
+
+    // Expand rows into the scratch buffer back-to-back, writing it whenever it gets full
+    WGFX_U8 *chunk = acquireScratch(self);
+    WGFX_SIZET chunkPixels = 0;
+    for(unsigned row = 0; row < h; row++)
     {
-        // Need to draw the image row-by-row...
-        const WGFX_SIZET imageRowStride = imgW * self->bpp;
-        WGFX_SIZET bytesPerChunk = MIN(scratchSizeB, w * self->bpp);
-        if(rodata)
-        {
-            for(WGFX_SIZET iByte = 0; iByte < rectSizeB; iByte += bytesPerChunk)
-            {
-                bytesPerChunk = MIN(bytesPerChunk, rectSizeB - iByte);
-                WGFX_RODATA_MEMCPY(self->scratchData, image, bytesPerChunk);
-                self->write(self->scratchData, bytesPerChunk, self->userPtr);
-                image += imageRowStride;
-            }
-        }
-        else
+        for(unsigned col = 0; col < w;)
         {
-            for(WGFX_SIZET iByte = 0; iByte < rectSizeB; iByte += bytesPerChunk)
+            const unsigned n = (unsigned)MIN(w - col, maxChunkPixels - chunkPixels);
+            expandIndexedPixels(chunk + chunkPixels * self->bpp, image, indexBits, palette, lut, self->bpp, rodata, srcX + col, n);
+            chunkPixels += n;
+            col += n;
+            if(chunkPixels == maxChunkPixels)
             {
-                bytesPerChunk = MIN(bytesPerChunk, rectSizeB - iByte);
-                self->write(image, bytesPerChunk, self->userPtr);
-                image += imageRowStride;
+                screenWrite(self, chunk, chunkPixels * self->bpp);
+                chunk = acquireScratch(self);
+                chunkPixels = 0;
             }
         }
+        image += imageRowStride;
+    }
+    if(chunkPixels > 0)
+    {
+        screenWrite(self, chunk, chunkPixels * self->bpp);
     }
 
-    self->endWrite(self->userPtr);
+    screenEndWrite(self);
 }
 
-void wgfxTextBoundsMono(WGFXscreen *self, const char *string, unsigned length,
-                        unsigned x, unsigned y, unsigned *w, unsigned *h,
-                        const WGFXmonoFont *font, unsigned scale, WGFXwrapMode wrapMode)
+/// Cuts the `*w * *h` bounds of text at `x`, `y` at the right and bottom edges of the clip rectangle;
+/// zeroes them if the text is entirely outside of it.
+static void clipTextBounds(const WGFXscreen *self, unsigned x, unsigned y, unsigned *w, unsigned *h)
+{
+    unsigned clipX = x, clipY = y, clipW = *w, clipH = *h;
+    if(!clipRect(self, &clipX, &clipY, &clipW, &clipH, 0, 0))
+    {
+        *w = *h = 0;
+        return;
+    }
+    *w = clipX + clipW - x;
+    *h = clipY + clipH - y;
+}
+
+/// Implements `wgfxTextBoundsMono()` (`utf8 = 0`) and `wgfxTextBoundsMonoUTF8()` (`utf8 = 1`).
+static void textBoundsMono(WGFXscreen *self, const char *string, unsigned length,
+                           unsigned x, unsigned y, unsigned *w, unsigned *h,
+                           const WGFXmonoFont *font, unsigned scale, WGFXwrapMode wrapMode, int utf8)
 {
     length = (length == 0) ? stringLength(string) : length;
     const char *const stringEnd = string + length;
@@ -390,8 +2046,9 @@ void wgfxTextBoundsMono(WGFXscreen *self, const char *string, unsigned length,
     if(!(wrapMode & (WGFX_WRAP_NEWLINE | WGFX_WRAP_RIGHT)))
     {
         // Fast-track
-        *w = charWidth * length;
+        *w = charWidth * countCodepoints(string, length, utf8);
         *h = lineHeight;
+        clipTextBounds(self, x, y, w, h);
         return;
     }
 
@@ -406,9 +2063,10 @@ void wgfxTextBoundsMono(WGFXscreen *self, const char *string, unsigned length,
     }
 #endif
 
-    for(const char *ch = string; ch < stringEnd; ch++)
+    for(const char *ch = string; ch < stringEnd;)
     {
-        if(*ch == '\n' && (wrapMode & WGFX_WRAP_NEWLINE))
+        const WGFX_U32 cp = nextCodepoint(&ch, stringEnd, utf8);
+        if(cp == '\n' && (wrapMode & WGFX_WRAP_NEWLINE))
         {
             x = startX;
             y += lineHeight;
@@ -429,10 +2087,20 @@ void wgfxTextBoundsMono(WGFXscreen *self, const char *string, unsigned length,
 
     *h = y - startY;
 
-#ifndef WGFX_NO_CLIPPING
-    *w = MIN(maxX - startX, self->width - startX);
-    *h = MIN(*h, self->height - startY);
-#else
     *w = maxX - startX;
-#endif
+    clipTextBounds(self, startX, startY, w, h);
+}
+
+void wgfxTextBoundsMono(WGFXscreen *self, const char *string, unsigned length,
+                        unsigned x, unsigned y, unsigned *w, unsigned *h,
+                        const WGFXmonoFont *font, unsigned scale, WGFXwrapMode wrapMode)
+{
+    textBoundsMono(self, string, length, x, y, w, h, font, scale, wrapMode, 0);
+}
+
+void wgfxTextBoundsMonoUTF8(WGFXscreen *self, const char *string, unsigned length,
+                            unsigned x, unsigned y, unsigned *w, unsigned *h,
+                            const WGFXmonoFont *font, unsigned scale, WGFXwrapMode wrapMode)
+{
+    textBoundsMono(self, string, length, x, y, w, h, font, scale, wrapMode, 1);
 }
@@ -20,14 +20,137 @@ typedef void (*WGFXbeginWritePFN)(unsigned x, unsigned y, unsigned w, unsigned h
 /// See `WGFXscreen::write`.
 typedef void (*WGFXwritePFN)(const WGFX_U8 *buf, WGFX_SIZET size, void *userPtr);
 
+/// A function that writes the same pixel to the screen `count` times.
+/// See `WGFXscreen::writeRepeat`.
+typedef int (*WGFXwriteRepeatPFN)(const WGFX_U8 *pixel, WGFX_SIZET count, void *userPtr);
+
 /// A function that ends a screen write.
 /// See `WGFXscreen::endWrite`.
 typedef void (*WGFXendWritePFN)(void *userPtr);
 
+/// A function that blocks until the screen is done reading from a part of memory previously passed to `write()`.
+/// See `WGFXscreen::waitWrite`.
+typedef void (*WGFXwaitWritePFN)(const WGFX_U8 *buf, void *userPtr);
+
+/// A function that scrolls a vertical area of the screen.
+/// See `WGFXscreen::scroll`.
+typedef void (*WGFXscrollPFN)(unsigned top, unsigned height, unsigned offset, void *userPtr);
+
+/// A function that blends a foreground color over a background one.
+/// See `WGFXscreen::blend`.
+typedef void (*WGFXblendPFN)(WGFX_U8 *dst, const WGFX_U8 *fgColor, const WGFX_U8 *bgColor, unsigned alpha, void *userPtr);
+
+/// A bitmask of screen flags.
+typedef enum
+{
+    /// Split the scratch buffer in two halves of `scratchSize / 2` pixels each; the library renders
+    /// to one half while the other one is (possibly still) being written to the screen.
+    WGFX_SCREEN_DOUBLE_BUFFER = 0x1,
+
+    /// Render text (`wgfxDrawTextMono()`, `wgfxDrawTextMonoUTF8()`) to the scratch buffer as a 1-bit foreground/background
+    /// mask, that is expanded to `bpp` bytes per pixel right before `write()` (to two small buffers, taking 1/4 of the
+    /// scratch buffer). Each address window can then be up to `6 * bpp` times bigger, at the cost of more `write()`s.
+    /// Ignored for transparent text (null `bgColor`), anti-aliased fonts and if the scratch buffer is too small.
+    WGFX_SCREEN_MASK_TEXT = 0x2,
+} WGFXscreenFlags;
+
+/// A rotation of everything drawn to a screen, clockwise (see `WGFXscreen::rotation`).
+typedef enum
+{
+    WGFX_ROTATE_0 = 0,
+    WGFX_ROTATE_90 = 1,
+    WGFX_ROTATE_180 = 2,
+    WGFX_ROTATE_270 = 3,
+} WGFXrotation;
+
+#ifdef WGFX_STATS
+// `WGFX_STATS`: #define it to keep performance counters in each `WGFXscreen` (see `WGFXstats`).
+// When not defined, the counters and the code that updates them are compiled out entirely.
+
+/// A function that returns the current value of a free-running cycle counter (e.g. `DWT->CYCCNT` on Cortex-M).
+/// See `WGFXscreen::cycles`.
+typedef WGFX_U32 (*WGFXcyclesPFN)(void *userPtr);
+
+/// Performance counters of a `WGFXscreen`, updated by the library. Zero them to reset them.
+typedef struct
+{
+    /// Number of `beginWrite()` calls (i.e. address windows set up).
+    WGFX_U32 beginWrites;
+
+    /// Number of `write()` and (successful) `writeRepeat()` calls.
+    WGFX_U32 writes;
+
+    /// Total bytes passed to `write()`, and written through `writeRepeat()`.
+    WGFX_U32 bytesWritten;
+
+    /// Total bytes that could have been passed to `write()`: the size of the scratch buffer (or of one half of it, in
+    /// `WGFX_SCREEN_DOUBLE_BUFFER` mode) is added for each `write()`. Scratch utilization is `bytesWritten / this`.
+    WGFX_U32 scratchBytes;
+
+    /// Number of characters rendered (including partially clipped ones).
+    WGFX_U32 glyphs;
+
+    /// Cycles spent in `beginWrite()`, `write()`, `writeRepeat()` and `endWrite()`; only counted if `cycles` is set.
+    /// The time spent rendering is the time spent in drawing functions minus this and `waitCycles`.
+    WGFX_U32 backendCycles;
+
+    /// Cycles spent in `waitWrite()` (i.e. waiting for the screen to be done with a buffer); only counted if
+    /// `cycles` is set.
+    WGFX_U32 waitCycles;
+} WGFXstats;
+#endif
+
+/// A slot of a `WGFXglyphCache`, holding one character rendered with a given font, scale, colors and blend function.
+typedef struct
+{
+    /// The font of the character in this slot, or null if the slot is empty.
+    const WGFXmonoFont *font;
+
+    /// The character's codepoint, and its foreground/background colors (their first 4 bytes, as a 32-bit word).
+    WGFX_U32 codepoint, fgKey, bgKey;
+
+    /// The `WGFXscreen::blend` its anti-aliased edges were shaded with (null for fonts that are not anti-aliased).
+    WGFXblendPFN blend;
+
+    /// The scale and bytes per pixel it was rendered at; whether it was used since the cache's clock hand last passed.
+    WGFX_U8 scale, bpp, referenced;
+} WGFXglyphCacheSlot;
+
+/// A cache of fully-rendered characters (see `WGFXscreen::glyphCache`), in a user-provided memory arena.
+/// Init it with `wgfxGlyphCacheInit()`.
+typedef struct
+{
+    /// The slots of the cache (library-managed), and the pixel data of each one: `slotSize` bytes, in slot order.
+    WGFXglyphCacheSlot *slots;
+    WGFX_U8 *pixels;
+    unsigned slotCount;
+    WGFX_SIZET slotSize;
+
+    /// Library-internal: the next slot to consider for eviction (clock algorithm).
+    unsigned hand;
+
+    /// Number of characters found in the cache, and of ones that had to be rendered (and were then cached).
+    /// Zero them to reset them.
+    WGFX_U32 hits, misses;
+} WGFXglyphCache;
+
+/// A rectangle, in screen coordinates.
+typedef struct
+{
+    unsigned x, y, w, h;
+} WGFXrect;
+
+#ifndef WGFX_NO_CLIPPING
+#    ifndef WGFX_CLIP_STACK_SIZE
+// `WGFX_CLIP_STACK_SIZE`: the maximum number of clip rectangles that can be pushed at once (see `wgfxPushClip()`).
+#        define WGFX_CLIP_STACK_SIZE 4
+#    endif
+#endif
+
 /// An instance of weegfx.
 typedef struct
 {
-    /// Width and height of the screen in pixels.
+    /// Width and height of the screen in pixels (as drawn to, i.e. after `rotation`).
     unsigned width, height;
 
     /// Bytes per pixel as stored in the screen framebuffer and scratch buffer.
@@ -36,8 +159,10 @@ typedef struct
     /// Size in _pixels_ of the scratch buffer.
     ///
     /// Due to the inner workings of the library, the ideal `scratchSize` is:
-    /// - A multiple of the screen height
+    /// - A multiple of the screen height (with a 90 or 270 degrees `rotation`, of its `width` too: that is the panel's
+    ///   height, and the one that rotated rows of pixels are sent as)
     /// - Enough to contain at least one character of the biggest font used
+    /// (in `WGFX_SCREEN_DOUBLE_BUFFER` mode, these apply to `scratchSize / 2` instead)
     WGFX_SIZET scratchSize;
 
     /// The scratch buffer; must be at least `fbSize` bytes in size.
@@ -62,9 +187,98 @@ typedef struct
     /// This is called after `beginWrite()` and `write()`[s] have happened.
     WGFXendWritePFN endWrite;
 
-    /// User data pointer passed to `beginWrite`, `write` and `endWrite`.
+    /// User data pointer passed to `beginWrite`, `write`, `endWrite` and `waitWrite`.
     void *userPtr;
 
+    /// A bitmask of `WGFXscreenFlags`. Set to 0 for the default behaviour.
+    WGFXscreenFlags flags;
+
+    /// Used by the library before rendering to a part of memory that was previously passed to `write()`; it should
+    /// block until the screen is done reading from any byte of the region that `buf` is the start of. Can be null.
+    /// For a `buf` in the scratch buffer, that region is the whole scratch buffer (or, in `WGFX_SCREEN_DOUBLE_BUFFER`
+    /// mode, the half of it that `buf` is in), and writes can be from anywhere inside it - not just from `buf`
+    /// (e.g. the visible rows of clipped text); for any other buffer, writes are always from `buf` itself.
+    /// `wgfxWaitWriteRegion()` returns the region for a `buf`.
+    ///
+    /// Backends whose `write()` returns before the transfer is complete (e.g. DMA) should implement this.
+    /// Leaving it null is only safe if `write()` is done with a buffer before returning, or - in `WGFX_SCREEN_DOUBLE_BUFFER`
+    /// mode - if it is done with all previously-passed buffers before returning (i.e. at most one transfer in flight).
+    WGFXwaitWritePFN waitWrite;
+
+    /// Used by the library, if not null, to write `count` copies of the same `bpp`-bytes `pixel` to the screen.
+    /// It is called in place of `write()` to fill solid-color areas without going through the scratch buffer.
+    ///
+    /// `pixel` is only guaranteed to be valid until `writeRepeat()` returns; copy it if it needs to outlive the call.
+    /// Should return false if it cannot repeat this particular pixel, in which case nothing must be written and the
+    /// library falls back to `write()`.
+    WGFXwriteRepeatPFN writeRepeat;
+
+    /// Library-internal: the half of the scratch buffer to render to next in `WGFX_SCREEN_DOUBLE_BUFFER` mode.
+    /// Initialize to 0.
+    unsigned scratchHalf;
+
+#ifdef WGFX_STATS
+    /// Performance counters (only with `WGFX_STATS`). Initialize to all zeros.
+    WGFXstats stats;
+
+    /// Used by the library, if not null, to time backend calls for `stats`. Gets passed `userPtr`.
+    /// Only with `WGFX_STATS`.
+    WGFXcyclesPFN cycles;
+#endif
+
+#ifndef WGFX_NO_CLIPPING
+    /// Library-internal: the clip rectangles pushed by `wgfxPushClip()`, each already intersected with the previous one.
+    /// `clipDepth` of them are in use. Initialize `clipDepth` to 0 (= only clip to the screen).
+    WGFXrect clipStack[WGFX_CLIP_STACK_SIZE];
+    unsigned clipDepth;
+#endif
+
+    /// Used by the library, if not null, to scroll the `height` rows of the screen starting at `top` (e.g. via the
+    /// ILI9341/ST7789 VSCRDEF and VSCRSADD commands): the screen should then show row `offset` of its memory at row `top`,
+    /// with the rows after it following and wrapping around to `top` at `top + height` (`top <= offset < top + height`).
+    /// Writes (`beginWrite()`) still address the screen's memory, not what it shows. See `WGFXconsole`.
+    /// Not used with a `rotation`.
+    WGFXscrollPFN scroll;
+
+    /// Used by the library, if not null, to cache characters drawn by `wgfxDrawTextMono()`, `wgfxDrawTextMonoUTF8()`,
+    /// `wgfxDrawTextBlockMono()` (and whatever is built on them) as fully expanded pixels: characters found in the
+    /// cache are copied to the scratch buffer instead of being rendered from the font again.
+    /// Only used for opaque text (with a `bgColor`), with `bpp <= 4`, whose characters fit the cache's `slotSize`.
+    /// Can be shared by screens: characters are cached per `bpp` and (for anti-aliased fonts) per `blend` function, so
+    /// screens sharing both must have their `blend` give the same colors whatever their `userPtr`.
+    WGFXglyphCache *glyphCache;
+
+    /// How everything drawn to the screen is rotated, in software (for panels whose own rotation, e.g. MADCTL, would
+    /// break tearing-free updates). Set to `WGFX_ROTATE_0` for none.
+    /// With a rotation, drawing functions see a `width * height` screen, while `beginWrite()` and `write()` get the
+    /// coordinates and pixel order of the panel (swap `width` and `height` for 90 and 270 degrees).
+    /// Fills, bitmaps drawn by `wgfxDrawBitmap()`/`wgfxDrawBitmapRegion()` and text in `WGFX_FONT_ROTATED_*` fonts are
+    /// rendered rotated; everything else is reordered through `rotateData` before being written. `scroll` is not used.
+    WGFXrotation rotation;
+
+    /// Optional, with a `rotation`: a buffer of `rotateSize` pixels that the output of primitives not rendered rotated
+    /// is reordered into before being written (in address windows of up to `rotateSize` pixels).
+    /// If null, text is reordered into the part of the scratch buffer it leaves free (if any), and everything else into
+    /// a small buffer on the stack (= many more, smaller windows).
+    WGFX_U8 *rotateData;
+    WGFX_SIZET rotateSize;
+
+    /// Library-internal: the address window being reordered for `rotation` (as drawn to), how many of its pixels were
+    /// written so far, and what the library is doing with it; the free scratch memory (`rotateSpareSize` bytes at
+    /// `rotateSpare`) its pixels can be reordered into without a `rotateData`, if any. Initialize `rotateState` to 0.
+    WGFXrect rotateWindow;
+    WGFX_SIZET rotatePos;
+    unsigned rotateState;
+    WGFX_U8 *rotateSpare;
+    WGFX_SIZET rotateSpareSize;
+
+    /// Used by the library, if not null, to draw text in anti-aliased fonts (see `WGFX_FONT_AA2`): it should write to
+    /// `dst` the `bpp`-bytes color that `fgColor` is when drawn over `bgColor` with an opacity of `alpha` (0 to 255).
+    /// Gets passed `userPtr`; `dst` can be `bgColor`.
+    /// Only called to make a table of the 4 or 16 shades of each text drawing call, not per pixel (except for the edges
+    /// of transparent text in display lists). If null, each byte of the colors is blended on its own: right for 8-bit
+    /// grayscale and RGB888-like formats, but not for RGB565 (see `wgfxBlendRGB565()`).
+    WGFXblendPFN blend;
 } WGFXscreen;
 
 /// A color in weegfx, i.e. an array of `bpp` bytes used to represent a single pixel.
@@ -83,38 +297,377 @@ typedef enum
 typedef enum
 {
     WGFX_BITMAP_RODATA = 0x1, ///< The bitmap data is in `WGFX_RODATA` and requires special care when reading.
+    WGFX_BITMAP_RLE = 0x2,    ///< The bitmap data is run-length encoded (see `wgfxDrawBitmap()`).
 } WGFXbitmapFlags;
 
+#ifndef WGFX_NO_CLIPPING
+/// Pushes a clip rectangle: until it is popped, drawing functions only draw the parts of their output that are inside
+/// it (and inside all previously pushed ones) - and skip sending anything outside of it to the screen entirely.
+/// Text is still laid out (and wrapped) as if no clip rectangle was set.
+/// Returns false if `WGFX_CLIP_STACK_SIZE` rectangles are already pushed.
+int wgfxPushClip(WGFXscreen *self, unsigned x, unsigned y, unsigned w, unsigned h);
+
+/// Pops the last clip rectangle pushed by `wgfxPushClip()` (if any).
+void wgfxPopClip(WGFXscreen *self);
+#endif
+
+/// Outputs the region of memory `[*begin, *end)` that the screen must be done reading from when the library calls
+/// `waitWrite(buf)` (see `WGFXscreen::waitWrite`): for backends that have writes in flight, any of them that overlaps
+/// it must complete before `waitWrite()` returns.
+void wgfxWaitWriteRegion(const WGFXscreen *self, const WGFX_U8 *buf, const WGFX_U8 **begin, const WGFX_U8 **end);
+
+/// Returns true if a write of the `size` bytes at `xferBuf` that is still in flight must complete before `waitWrite(buf)`
+/// returns, i.e. if it overlaps the region of `wgfxWaitWriteRegion()`.
+int wgfxWaitWriteOverlaps(const WGFXscreen *self, const WGFX_U8 *buf, const WGFX_U8 *xferBuf, WGFX_SIZET size);
+
 /// Fills a rectangle with the given color.
 /// `color` is a buffer of `bpp` bytes.
+/// Uses `writeRepeat()` if available, filling and streaming the scratch buffer otherwise.
 void wgfxFillRect(WGFXscreen *self, unsigned x, unsigned y, unsigned w, unsigned h, const WGFXcolor color);
 
+/// Fills `count` rectangles with the given color, as `wgfxFillRect()` would for each of them - but with fewer address
+/// windows: each run of consecutive rectangles that together make up a bigger one (stacked vertically, side by side,
+/// or one inside the other) is merged and sent in a single window, and the scratch buffer is only filled once.
+/// Pass rectangles in order (e.g. the segments of a bar from top to bottom) to get the most out of this.
+void wgfxFillRects(WGFXscreen *self, const WGFXrect *rects, unsigned count, const WGFXcolor color);
+
+/// Like `wgfxFillRects()`, but fills each rectangle `rects[i]` with `palette[colorIndices[i]]`.
+/// Rectangles are filled in order (later ones overwrite earlier ones); only consecutive ones of the same color index
+/// are merged, and the scratch buffer is only refilled when the color changes.
+void wgfxFillRectsIndexed(WGFXscreen *self, const WGFXrect *rects, const WGFX_U8 *colorIndices, unsigned count,
+                          const WGFXcolor *palette);
+
+/// Draws a 1 pixel wide line from `x0`, `y0` to `x1`, `y1` (both included).
+/// The line is sent as horizontal spans, one per row; vertical runs of pixels are merged into a single window.
+void wgfxDrawLine(WGFXscreen *self, unsigned x0, unsigned y0, unsigned x1, unsigned y1, const WGFXcolor color);
+
+/// Draws the 1 pixel wide outline of a circle of radius `r` centered on `cx`, `cy`.
+/// Parts of it outside the screen (including left/above it) are clipped away.
+void wgfxDrawCircle(WGFXscreen *self, unsigned cx, unsigned cy, unsigned r, const WGFXcolor color);
+
+/// Fills a circle of radius `r` centered on `cx`, `cy`; see `wgfxFillRoundRect()` for `bgColor`.
+void wgfxFillCircle(WGFXscreen *self, unsigned cx, unsigned cy, unsigned r, const WGFXcolor color, const WGFXcolor bgColor);
+
+/// Fills a `w * h` rectangle at `x`, `y` with corners rounded to a radius of `r` (at most half its smallest side).
+/// If `bgColor` is null, only the shape is drawn, as horizontal spans (rows covering the same span are merged into
+/// a single window). Otherwise the rest of its bounding box is filled with `bgColor`, and the whole box is
+/// rasterized band by band in the scratch buffer and sent in a single window (or, if `scratchSize` is not enough to
+/// hold one row of the box, filled as spans around the shape).
+void wgfxFillRoundRect(WGFXscreen *self, unsigned x, unsigned y, unsigned w, unsigned h, unsigned r,
+                       const WGFXcolor color, const WGFXcolor bgColor);
+
 /// Draws a string in monospace font. Overwrites the background!
 /// If `length` is 0, `strlen(string)` is used.
-/// `fgColor` and `bgColor` represent the text color and background color respectively.
+/// `fgColor` and `bgColor` represent the text color and background color respectively; the edges of characters in
+/// anti-aliased fonts (see `WGFX_FONT_AA2`) are drawn in shades between them.
 /// `*x` and `*y` is the position of the top-left corner of the first letter of the text;
 /// they are set to the position of the top-right corner of the last letter when the function returns.
 /// If `scale` is `> 1`, the font will be upscaled (nearest neighbour) by that factor before drawing.
 ///
 /// Returns false on failure - usually because `scratchSize` is not enough to hold at least one character of the text...
+/// (or because `font` is pre-rotated, see `WGFX_FONT_ROTATED_90`, for a different `WGFXscreen::rotation`; or
+/// anti-aliased, with `WGFX_NO_AA_FONTS`).
 int wgfxDrawTextMono(WGFXscreen *self, const char *string, unsigned length, unsigned *x, unsigned *y,
                      const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor, WGFXwrapMode wrapMode);
 
+/// Like `wgfxDrawTextMono()`, but `string` is UTF-8 encoded (and `length`, if nonzero, is in bytes).
+/// Codepoints are looked up in `font` as they are; use a sparse font (see `WGFXmonoFont::ranges`) for codepoints
+/// beyond 255. Invalid sequences are drawn as U+FFFD.
+int wgfxDrawTextMonoUTF8(WGFXscreen *self, const char *string, unsigned length, unsigned *x, unsigned *y,
+                         const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor, WGFXwrapMode wrapMode);
+
+/// Redraws `newString`, that replaces `oldString` at `x`, `y` (as drawn by `wgfxDrawTextMono()` with the same
+/// parameters), by only drawing the runs of characters that differ between the two - e.g. for counters and clocks.
+/// If `length` is 0, both strings are NUL-terminated; characters of `newString` past the end of `oldString` count as
+/// changed, while characters of `oldString` past the end of `newString` are NOT erased (pad `newString` with spaces).
+/// If newlines are not in the same places in both strings, the whole of `newString` is redrawn.
+///
+/// Returns false on failure (see `wgfxDrawTextMono()`).
+int wgfxUpdateTextMono(WGFXscreen *self, const char *oldString, const char *newString, unsigned length, unsigned x, unsigned y,
+                       const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor, WGFXwrapMode wrapMode);
+
+/// Like `wgfxDrawTextMono()`, but draws all lines of text in a single address window (one `beginWrite()`), calling
+/// `write()` once per scratch buffer full of whole lines instead of at least once per line.
+/// The window starts at `*x`, `*y` and is as wide as the longest line; shorter lines are padded with `bgColor`.
+/// Lines wrap as specified by `wrapMode` (with `WGFX_WRAP_RIGHT`, only whole characters are drawn on each line).
+///
+/// Falls back to `wgfxDrawTextMono()` if `scratchSize` is not enough to hold at least one whole line of the window,
+/// and for pre-rotated fonts.
+/// Returns false on failure (see `wgfxDrawTextMono()`).
+int wgfxDrawTextBlockMono(WGFXscreen *self, const char *string, unsigned length, unsigned *x, unsigned *y,
+                          const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor, WGFXwrapMode wrapMode);
+
+/// Inits `cache` to use the `arenaSize` bytes at `arena` (aligned to a pointer) for characters up to `slotSize` bytes
+/// each (i.e. `width * height * scale^2 * bpp` of the biggest character to cache).
+/// Returns the number of characters that fit the cache (0 if `arena` is too small for even one).
+unsigned wgfxGlyphCacheInit(WGFXglyphCache *cache, void *arena, WGFX_SIZET arenaSize, WGFX_SIZET slotSize);
+
+/// Empties `cache`; needed if the data of a cached font is changed.
+void wgfxGlyphCacheClear(WGFXglyphCache *cache);
+
+/// `WGFXscreen::blend` functions for RGB565 colors: stored high byte first (as sent over an 8-bit bus), or as native,
+/// little-endian 16-bit values (e.g. for `WGFX_STM32_SPI_16BIT`). `userPtr` is ignored.
+void wgfxBlendRGB565(WGFX_U8 *dst, const WGFX_U8 *fgColor, const WGFX_U8 *bgColor, unsigned alpha, void *userPtr);
+void wgfxBlendRGB565LE(WGFX_U8 *dst, const WGFX_U8 *fgColor, const WGFX_U8 *bgColor, unsigned alpha, void *userPtr);
+
 /// Estimates the `w`idth and `h`eight of the bounding rectangle of a string as it were drawn by `wgfxDrawTextMono()`.
 /// Applies wrapping and clipping according to `wrapMode`.
-/// Note that the outputted `w` and `h` might describe a rectangle that goes beyond the screen's bounds!
+/// The rectangle is cut at the right and bottom edges of the clip rectangle (see `wgfxPushClip()`), or of the screen;
+/// `w` and `h` are 0 if the text would be clipped away entirely.
 void wgfxTextBoundsMono(WGFXscreen *self, const char *string, unsigned length, unsigned x, unsigned y, unsigned *w, unsigned *h,
                         const WGFXmonoFont *font, unsigned scale, WGFXwrapMode wrapMode);
 
+/// Like `wgfxTextBoundsMono()`, but for UTF-8 encoded strings as drawn by `wgfxDrawTextMonoUTF8()`.
+void wgfxTextBoundsMonoUTF8(WGFXscreen *self, const char *string, unsigned length, unsigned x, unsigned y, unsigned *w, unsigned *h,
+                            const WGFXmonoFont *font, unsigned scale, WGFXwrapMode wrapMode);
+
 /// Draws (at most) `w * h` pixels of `image` (that is a `imgW * imgH` bitmap) to the screen, at position `x`,`y`.
 ///
 /// Data in `image` is contiguous top-to-bottom, left-to-right, `bpp` bytes per pixel.
 /// If `flags & WGFX_BITMAP_RODATA` the image is assumed to be `WGFX_RODATA`, so its pixel data is loaded to memory
 /// (in chunks) before drawing it.
+///
+/// If `flags & WGFX_BITMAP_RLE` the image is run-length encoded instead, and is decoded to the scratch buffer
+/// in chunks while drawing it. The encoded data is a sequence of packets (that can span multiple rows), each starting
+/// with a header byte `n`:
+/// - `n < 0x80`: a literal packet; `n + 1` pixels follow, `bpp` bytes each;
+/// - `n >= 0x80`: a run packet; one pixel follows (`bpp` bytes), to be repeated `n - 0x80 + 1` times.
+/// `tools/bitmapconv.py` can be used to encode images in this format.
 void wgfxDrawBitmap(WGFXscreen *self, const WGFX_U8 *image, unsigned imgW, unsigned imgH,
                     unsigned x, unsigned y, unsigned w, unsigned h,
                     WGFXbitmapFlags flags);
 
+/// Draws the `w * h` pixels of `image` starting at `srcX`,`srcY` to the screen, at position `x`,`y` - for example,
+/// a frame of a sprite sheet or a glyph of an atlas.
+///
+/// `imgStride` is the distance in bytes between the starts of two rows of `image` (i.e. `imgW * bpp` for images in
+/// the format of `wgfxDrawBitmap()`); the region is NOT clipped to the bounds of the image, only to the screen.
+/// `flags & WGFX_BITMAP_RODATA` is supported as in `wgfxDrawBitmap()`: only the bytes in the region are loaded.
+/// `WGFX_BITMAP_RLE` is not supported.
+void wgfxDrawBitmapRegion(WGFXscreen *self, const WGFX_U8 *image, WGFX_SIZET imgStride, unsigned srcX, unsigned srcY,
+                          unsigned x, unsigned y, unsigned w, unsigned h, WGFXbitmapFlags flags);
+
+/// Draws (at most) `w * h` pixels of `image` (that is a `imgW * imgH` palette-indexed bitmap) to the screen,
+/// at position `x`,`y`, expanding indices to colors in the scratch buffer (in chunks).
+///
+/// Data in `image` is contiguous top-to-bottom, left-to-right, `indexBits` (1, 2, 4 or 8) bits per pixel, MSB first;
+/// each row starts on a new byte. Each index selects a color in `palette`, that must have an entry for every index
+/// used in the image.
+/// `flags & WGFX_BITMAP_RODATA` is supported as in `wgfxDrawBitmap()`; `WGFX_BITMAP_RLE` is not.
+void wgfxDrawIndexedBitmap(WGFXscreen *self, const WGFX_U8 *image, unsigned indexBits, const WGFXcolor *palette,
+                           unsigned imgW, unsigned imgH, unsigned x, unsigned y, unsigned w, unsigned h,
+                           WGFXbitmapFlags flags);
+
+/// The type of a `WGFXcmd`.
+typedef enum
+{
+    WGFX_CMD_FILL_RECT = 0, ///< See `wgfxCmdFillRect()`
+    WGFX_CMD_TEXT_MONO,     ///< See `wgfxCmdTextMono()`
+    WGFX_CMD_BITMAP,        ///< See `wgfxCmdBitmap()`
+} WGFXcmdType;
+
+/// A drawing command recorded in a `WGFXcmdList`. Use the `wgfxCmd*()` functions to record them.
+typedef struct
+{
+    /// The type of command.
+    WGFXcmdType type;
+
+    /// The rectangle of the screen affected by the command (not clipped to the screen's bounds).
+    unsigned x, y, w, h;
+
+    /// Fill or text color.
+    WGFXcolor color;
+
+    /// Command-specific parameters, depending on `type`.
+    union
+    {
+        struct
+        {
+            const char *string;
+            unsigned length;
+            const WGFXmonoFont *font;
+            unsigned scale;
+            WGFXcolor bgColor; ///< Null for transparent text.
+            WGFXwrapMode wrapMode;
+        } text;
+
+        struct
+        {
+            const WGFX_U8 *image;
+            unsigned imgW;
+            WGFXbitmapFlags flags;
+        } bitmap;
+    } params;
+} WGFXcmd;
+
+/// A display list, i.e. a list of recorded drawing commands to render all at once via `wgfxDrawCmdList()`.
+///
+/// The list only stores pointers to colors, strings and images passed to the `wgfxCmd*()` functions;
+/// they must stay valid until the list has been drawn for the last time!
+typedef struct
+{
+    /// The storage for commands (an array of `capacity` commands).
+    WGFXcmd *cmds;
+
+    /// The maximum number of commands in `cmds`.
+    unsigned capacity;
+
+    /// The number of commands currently recorded. Set to 0 to clear the list.
+    unsigned count;
+
+    /// Optional, can be null: an array of `bandHashCount` hashes of the bands drawn by the last `wgfxDrawCmdList()`.
+    /// If present, bands whose contents did not change since the last time they were drawn are not sent to the screen.
+    /// Entries are only meaningful for the same screen and area; set them all to 0 (see `wgfxCmdListInvalidate()`)
+    /// to force a full redraw. Bands past `bandHashCount` are always sent.
+    WGFX_U32 *bandHashes;
+
+    /// The number of entries in `bandHashes`.
+    unsigned bandHashCount;
+} WGFXcmdList;
+
+/// Resets all `bandHashes` of `list`, so that the next `wgfxDrawCmdList()` sends all bands to the screen.
+void wgfxCmdListInvalidate(WGFXcmdList *list);
+
+/// Records a `wgfxFillRect()`-like command to the list.
+/// Returns false if the list is full.
+int wgfxCmdFillRect(WGFXcmdList *list, unsigned x, unsigned y, unsigned w, unsigned h, const WGFXcolor color);
+
+/// Records a `wgfxDrawTextMono()`-like command to the list.
+/// If `bgColor` is null the text is transparent, i.e. only its foreground pixels are drawn.
+/// Only `WGFX_WRAP_NEWLINE` is supported in `wrapMode`; text is always clipped at the right screen edge.
+/// Returns false if the list is full (or if `font` is anti-aliased, with `WGFX_NO_AA_FONTS`).
+int wgfxCmdTextMono(WGFXcmdList *list, const char *string, unsigned length, unsigned x, unsigned y,
+                    const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor, WGFXwrapMode wrapMode);
+
+/// Records a `wgfxDrawBitmap()`-like command to the list.
+/// Returns false if the list is full, or for `WGFX_BITMAP_RLE` bitmaps (that are not supported by display lists).
+int wgfxCmdBitmap(WGFXcmdList *list, const WGFX_U8 *image, unsigned imgW, unsigned imgH,
+                  unsigned x, unsigned y, unsigned w, unsigned h, WGFXbitmapFlags flags);
+
+/// Renders the `w * h` area of the screen at `x`, `y` by compositing all commands in `list` (in order, on top of a
+/// background of `clearColor`) in horizontal bands as tall as the scratch buffer allows, writing each band at once.
+/// Every pixel in the area is only sent to the screen once, and overlapping commands do not flicker.
+/// If `list->bandHashes` is set, each changed band is sent in its own address window and unchanged bands are skipped
+/// (the hashes of `list` are updated; they are all reset if the area is clipped); otherwise the whole area is sent in a
+/// single address window.
+///
+/// Returns false if `scratchSize` is not enough to contain at least one row of the area.
+int wgfxDrawCmdList(WGFXscreen *self, WGFXcmdList *list, unsigned x, unsigned y, unsigned w, unsigned h,
+                    const WGFXcolor clearColor);
+
+/// The type of a `WGFXop`.
+typedef enum
+{
+    WGFX_OP_DONE = 0,   ///< The operation is complete (or was never started).
+    WGFX_OP_FILL_RECT,  ///< See `wgfxBeginFillRect()`
+    WGFX_OP_BITMAP,     ///< See `wgfxBeginBitmap()`
+    WGFX_OP_TEXT_MONO,  ///< See `wgfxBeginTextMono()`
+} WGFXopType;
+
+/// A resumable drawing operation. Start one with a `wgfxBegin*()` function, then call `wgfxStep()` until it is done;
+/// all state is kept here, so that work can be spread over multiple calls (e.g. from an idle task).
+///
+/// While an operation is in progress its screen is in the middle of a write, so it must not be used for anything
+/// else (or by another operation) until the operation is done.
+typedef struct
+{
+    /// The type of operation; `WGFX_OP_DONE` once it is complete.
+    WGFXopType type;
+
+    /// The screen to draw to.
+    WGFXscreen *screen;
+
+    /// The area of the screen being drawn to (already clipped).
+    /// For text operations, `x` and `y` are the current position instead, as updated by `wgfxDrawTextMono()`.
+    unsigned x, y, w, h;
+
+    /// The number of pixels of the area sent so far.
+    WGFX_SIZET cursor;
+
+    /// Operation-specific parameters.
+    union
+    {
+        struct
+        {
+            WGFXcolor color;
+        } fill;
+
+        struct
+        {
+            const WGFX_U8 *image;
+            unsigned imgW;
+            WGFXbitmapFlags flags;
+        } bitmap;
+
+        struct
+        {
+            const char *iCh, *strEnd; //< The rest of the string to draw
+            const char *lineEnd;      //< The end of the line `iCh` is in (its '\n', or `strEnd`)
+            const WGFXmonoFont *font;
+            unsigned scale;
+            WGFXcolor fgColor, bgColor;
+            WGFXwrapMode wrapMode;
+            unsigned startX;
+        } text;
+    } params;
+} WGFXop;
+
+/// Starts a resumable `wgfxFillRect()`. Always returns true.
+int wgfxBeginFillRect(WGFXop *op, WGFXscreen *self, unsigned x, unsigned y, unsigned w, unsigned h, const WGFXcolor color);
+
+/// Starts a resumable `wgfxDrawBitmap()`.
+/// Returns false for `WGFX_BITMAP_RLE` bitmaps (that are not supported by resumable operations).
+int wgfxBeginBitmap(WGFXop *op, WGFXscreen *self, const WGFX_U8 *image, unsigned imgW, unsigned imgH,
+                    unsigned x, unsigned y, unsigned w, unsigned h, WGFXbitmapFlags flags);
+
+/// Starts a resumable `wgfxDrawTextMono()`; the current position is kept in `op->x`, `op->y`.
+/// Each step draws one chunk of a line: as many of its characters as fit the scratch buffer (and the screen,
+/// with `WGFX_WRAP_RIGHT`).
+/// Returns false if `scratchSize` is not enough to hold at least one character of the text.
+int wgfxBeginTextMono(WGFXop *op, WGFXscreen *self, const char *string, unsigned length, unsigned x, unsigned y,
+                      const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor, WGFXwrapMode wrapMode);
+
+/// Continues `op`, performing at most `budget` steps of work (0 counts as 1) before returning.
+/// A step renders and sends one scratch buffer's worth of pixels.
+/// Returns true if there is more work left, false once the operation is done.
+int wgfxStep(WGFXop *op, unsigned budget);
+
+/// A text console: a scrolling log of lines of monospace text, drawn in the `lines * lineHeight` rows of the screen
+/// starting at `y`, where `lineHeight` is the font's height times `scale`.
+///
+/// Its rows form a ring of lines: appending a line when the console is full overwrites the oldest one (that is at the
+/// top), then scrolls it to the bottom via `WGFXscreen::scroll` - so that each new line only costs sending a line
+/// of pixels instead of redrawing the whole console. If the screen cannot `scroll()`, the console wraps around to
+/// its top instead.
+typedef struct
+{
+    WGFXscreen *screen;
+    const WGFXmonoFont *font;
+    unsigned scale;
+    WGFXcolor fgColor, bgColor;
+
+    /// The first row of the console and its height in lines.
+    unsigned y, lines;
+
+    /// Library-internal: the line (in screen memory) shown at the top of the console, and the number of lines written
+    /// since the console was last cleared (up to `lines`).
+    unsigned first, count;
+} WGFXconsole;
+
+/// Inits `console` to draw text in `font` (upscaled by `scale`) in the `lines` lines starting at row `y` of `screen`,
+/// then clears it (see `wgfxConsoleClear()`).
+void wgfxConsoleInit(WGFXconsole *console, WGFXscreen *screen, unsigned y, unsigned lines, const WGFXmonoFont *font,
+                     unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor);
+
+/// Fills the console with its background color, resets its scrolling and starts over from its first line.
+void wgfxConsoleClear(WGFXconsole *console);
+
+/// Appends a line of text to the console; if the console is full, its oldest line is scrolled away.
+/// If `length` is 0, `strlen(string)` is used. The line is cut at the right edge of the screen; '\n' is not
+/// interpreted (split the text into separate lines instead). The rest of the line is filled with the background color.
+/// Returns false on failure (see `wgfxDrawTextMono()`).
+int wgfxConsolePutLine(WGFXconsole *console, const char *string, unsigned length);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,266 @@
+// weegfx.hpp - Optional, header-only C++ layer for weegfx with compile-time screen size, bpp and fonts.
+// Copyright (c) 2019 Paolo Jovon <paolo.jovon@gmail.com>
+// Released under the 3-clause BSD license (see LICENSE)
+//
+// `wgfx::Screen<Bpp, Width, Height>` wraps a `WGFXscreen`. Its `fillRect()` and `drawText()` instantiate the pixel
+// kernels with `Bpp`, the font's size and the text scale as compile-time constants, so that the compiler can unroll
+// and specialize them (fixed-size color copies, constant strides); anything they do not handle is forwarded to the
+// C core, as is everything else (through `c()`).
+#ifndef WEEGFX_HPP
+#define WEEGFX_HPP
+
+#include "weegfx.h"
+
+// (library-internal kernels and helpers, instantiated below with compile-time parameters)
+extern "C" {
+#include "weegfx/internal.h"
+#include "weegfx/kernels.h"
+}
+
+namespace wgfx
+{
+
+/// A dense, unpacked monospace font whose layout is known at compile time (see `tools/fontconv.py --cpp`).
+template <unsigned Width, unsigned Height, unsigned char FirstChar, unsigned char LastChar>
+struct MonoFont
+{
+    static constexpr unsigned width = Width, height = Height;
+    static constexpr unsigned char firstChar = FirstChar, lastChar = LastChar;
+
+    /// Bytes per row of pixels of a character, and per character, in `data`.
+    static constexpr unsigned rowBytes = (Width + 7) / 8;
+    static constexpr WGFX_SIZET charDataStride = (WGFX_SIZET)rowBytes * Height;
+
+    /// The character data, as in `WGFXmonoFont::data` (a `WGFX_RODATA` variable).
+    const WGFX_U8 *data;
+
+    /// Returns the equivalent C font, to pass to C functions.
+    WGFXmonoFont c() const
+    {
+        const WGFXmonoFont font = {Width, Height, (char)FirstChar, (char)LastChar, data, charDataStride,
+                                   (WGFXmonoFontFlags)0, nullptr, 0};
+        return font;
+    }
+};
+
+/// A screen of `Width * Height` pixels, `Bpp` bytes each.
+template <unsigned Bpp, unsigned Width, unsigned Height>
+class Screen
+{
+public:
+    static constexpr unsigned bpp = Bpp, width = Width, height = Height;
+
+    static_assert(Bpp >= 1 && Bpp <= 4, "Bpp must be between 1 and 4");
+#ifdef WGFX_FIXED_BPP
+    static_assert(Bpp == WGFX_FIXED_BPP, "Bpp must match WGFX_FIXED_BPP");
+#endif
+
+    /// Sets the screen up (see `WGFXscreen` for the meaning of each parameter); use `c()` to set anything else.
+    Screen(WGFX_U8 *scratchData, WGFX_SIZET scratchSize, WGFXbeginWritePFN beginWrite, WGFXwritePFN write,
+           WGFXendWritePFN endWrite, void *userPtr = nullptr)
+        : screen_()
+    {
+        screen_.width = Width;
+        screen_.height = Height;
+        screen_.bpp = Bpp;
+        screen_.scratchData = scratchData;
+        screen_.scratchSize = scratchSize;
+        screen_.beginWrite = beginWrite;
+        screen_.write = write;
+        screen_.endWrite = endWrite;
+        screen_.userPtr = userPtr;
+    }
+
+    /// The wrapped C screen, to set optional callbacks/flags and to pass to any other weegfx function.
+    WGFXscreen &c()
+    {
+        return screen_;
+    }
+    const WGFXscreen &c() const
+    {
+        return screen_;
+    }
+
+    /// Like `wgfxFillRect()`.
+    void fillRect(unsigned x, unsigned y, unsigned w, unsigned h, const WGFXcolor color)
+    {
+        WGFXscreen *const self = &screen_;
+        if(!clipRect(self, &x, &y, &w, &h, 0, 0)) return;
+
+        const WGFX_SIZET xferCount = (WGFX_SIZET)w * h;
+        screenBeginWriteRotated(self, x, y, w, h);
+        if(!screenWriteRepeat(self, (const WGFX_U8 *)color, xferCount))
+        {
+            WGFX_U8 *const scratch = acquireScratch(self);
+            const WGFX_SIZET fillCount = MIN(scratchPixels(self), xferCount);
+            fillPixels(scratch, (const WGFX_U8 *)color, Bpp, fillCount);
+            for(WGFX_SIZET sent = 0; sent < xferCount; sent += fillCount)
+            {
+                screenWrite(self, scratch, MIN(fillCount, xferCount - sent) * Bpp);
+            }
+        }
+        screenEndWrite(self);
+    }
+
+    /// Like `wgfxDrawTextMono()` with `WGFX_WRAP_NEWLINE`, upscaling the font by `Scale`.
+    /// Text that fits the screen is rendered by kernels specialized for the font and `Scale`; text that would need
+    /// clipping, a clip rectangle, `WGFX_SCREEN_MASK_TEXT` or a glyph cache is drawn by the C core instead.
+    template <unsigned Scale = 1, unsigned FW, unsigned FH, unsigned char First, unsigned char Last>
+    int drawText(const char *string, unsigned length, unsigned &x, unsigned &y, const MonoFont<FW, FH, First, Last> &font,
+                 const WGFXcolor fgColor, const WGFXcolor bgColor)
+    {
+        static_assert(Scale >= 1, "Scale must be at least 1");
+        constexpr unsigned charWidth = FW * Scale, charHeight = FH * Scale;
+
+        WGFXscreen *const self = &screen_;
+        length = (length == 0) ? stringLength(string) : length;
+        const unsigned maxChunkChars = (unsigned)(scratchPixels(self) / (charWidth * charHeight));
+        if(!fitsScreen(string, length, x, y, charWidth, charHeight) || maxChunkChars == 0 || !bgColor
+           || (self->flags & WGFX_SCREEN_MASK_TEXT) || self->glyphCache
+#ifndef WGFX_NO_CLIPPING
+           || self->clipDepth > 0
+#endif
+        )
+        {
+            const WGFXmonoFont cFont = font.c();
+            return wgfxDrawTextMono(self, string, length, &x, &y, &cFont, Scale, fgColor, bgColor, WGFX_WRAP_NEWLINE);
+        }
+
+        // As in `drawTextMono()`, `endWrite()` is deferred in double-buffered mode to overlap rendering and transfers
+        const int deferEndWrite = self->flags & WGFX_SCREEN_DOUBLE_BUFFER;
+        int writePending = 0;
+
+        const unsigned startX = x;
+        const char *iCh = string;
+        const char *const strEnd = string + length;
+        while(iCh < strEnd)
+        {
+            if(*iCh == '\n')
+            {
+                x = startX;
+                y += charHeight;
+                iCh++;
+                continue;
+            }
+
+            // Render as many characters of this line as fit the scratch buffer, and send them in one window
+            WGFX_U8 *const scratch = acquireScratch(self);
+            const unsigned chunkRowStride = maxChunkChars * charWidth * Bpp;
+            unsigned nChars = 0;
+            for(; nChars < maxChunkChars && iCh < strEnd && *iCh != '\n'; nChars++, iCh++)
+            {
+                writeChar<Scale, FW, FH, First, Last>(font, (unsigned char)*iCh, scratch + nChars * charWidth * Bpp,
+                                                      chunkRowStride, (const WGFX_U8 *)fgColor, (const WGFX_U8 *)bgColor);
+                WGFX_STATS_ADD(self, glyphs, 1);
+            }
+
+            if(writePending)
+            {
+                screenEndWrite(self);
+            }
+            screenBeginWrite(self, x, y, nChars * charWidth, charHeight);
+            if(nChars == maxChunkChars)
+            {
+                screenWrite(self, scratch, (WGFX_SIZET)chunkRowStride * charHeight);
+            }
+            else
+            {
+                for(unsigned row = 0; row < charHeight; row++)
+                {
+                    screenWrite(self, scratch + row * chunkRowStride, nChars * charWidth * Bpp);
+                }
+            }
+            if(deferEndWrite)
+            {
+                writePending = 1;
+            }
+            else
+            {
+                screenEndWrite(self);
+            }
+            x += nChars * charWidth;
+        }
+        if(writePending)
+        {
+            screenEndWrite(self);
+        }
+        return 1;
+    }
+
+    /// Like `wgfxDrawBitmap()` (bitmaps are copied, not expanded; there is nothing to specialize).
+    void drawBitmap(const WGFX_U8 *image, unsigned imgW, unsigned imgH, unsigned x, unsigned y, unsigned w, unsigned h,
+                    WGFXbitmapFlags flags = (WGFXbitmapFlags)0)
+    {
+        wgfxDrawBitmap(&screen_, image, imgW, imgH, x, y, w, h, flags);
+    }
+
+private:
+    WGFXscreen screen_;
+
+    /// Returns true if every line of the text starting at `x`, `y` is wholly inside the screen.
+    static bool fitsScreen(const char *string, unsigned length, unsigned x, unsigned y, unsigned charWidth,
+                           unsigned charHeight)
+    {
+        unsigned lineChars = 0;
+        for(unsigned i = 0; i <= length; i++)
+        {
+            if(i < length && string[i] != '\n')
+            {
+                lineChars++;
+                continue;
+            }
+            if(lineChars > 0 && (y + charHeight > Height || x + lineChars * charWidth > Width))
+            {
+                return false;
+            }
+            lineChars = 0;
+            y += charHeight;
+        }
+        return true;
+    }
+
+    /// Renders a whole character to `buffer`, whose rows are `rowStride` bytes apart.
+    template <unsigned Scale, unsigned FW, unsigned FH, unsigned char First, unsigned char Last>
+    WGFX_FORCEINLINE static void writeChar(const MonoFont<FW, FH, First, Last> &font, unsigned char ch, WGFX_U8 *buffer,
+                                           unsigned rowStride, const WGFX_U8 *fgColor, const WGFX_U8 *bgColor)
+    {
+        typedef MonoFont<FW, FH, First, Last> Font;
+        constexpr unsigned rowBytes = FW * Scale * Bpp;
+
+        if(ch < First || ch > Last)
+        {
+            for(unsigned row = 0; row < FH * Scale; row++)
+            {
+                fillPixels(buffer, bgColor, Bpp, FW * Scale);
+                buffer += rowStride;
+            }
+            return;
+        }
+
+        const WGFX_U8 *data = font.data + (ch - First) * Font::charDataStride;
+        for(unsigned fontRow = 0; fontRow < FH; fontRow++)
+        {
+            WGFX_U8 *dst = buffer;
+            for(unsigned byteCol = 0; byteCol < Font::rowBytes; byteCol++)
+            {
+                const WGFX_U8 bits = WGFX_RODATA_READU8(data + byteCol);
+                const unsigned nBits = (byteCol + 1 < Font::rowBytes) ? 8 : FW - byteCol * 8;
+                for(unsigned bit = 0; bit < nBits; bit++)
+                {
+                    const WGFX_U8 *const color = (bits & (0x80 >> bit)) ? fgColor : bgColor;
+                    for(unsigned i = 0; i < Scale; i++)
+                    {
+                        copyPixel(dst, color, Bpp);
+                        dst += Bpp;
+                    }
+                }
+            }
+            buffer = repeatRow(buffer, rowStride, rowBytes, Scale);
+            data += Font::rowBytes;
+        }
+    }
+};
+
+} // namespace wgfx
+
+#endif // WEEGFX_HPP
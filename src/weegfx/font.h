@@ -6,13 +6,47 @@
 
 #include "types.h"
 
+/// Flags for a `WGFXmonoFont`.
+typedef enum
+{
+    WGFX_FONT_PACKED = 0x1, ///< Glyph rows are not padded to whole bytes (see `WGFXmonoFont::data`).
+
+    /// Glyphs are stored pre-rotated clockwise by 90, 180 or 270 degrees (see `WGFXmonoFont::data`); such fonts can
+    /// only be drawn on screens with the same `WGFXscreen::rotation`, where they render as fast as unrotated ones.
+    WGFX_FONT_ROTATED_90 = 0x2,
+    WGFX_FONT_ROTATED_180 = 0x4,
+    WGFX_FONT_ROTATED_270 = 0x6,
+    WGFX_FONT_ROTATION_MASK = 0x6, ///< The bits of the flags that store the rotation.
+
+    /// Pixels are 2 or 4 bits of coverage each (from 0 = all background to all ones = all foreground) instead of 1
+    /// (see `WGFXmonoFont::data`); text in such fonts is drawn anti-aliased, blending its colors (see `WGFXscreen::blend`).
+    /// Not supported if the library is built with `WGFX_NO_AA_FONTS`.
+    WGFX_FONT_AA2 = 0x8,
+    WGFX_FONT_AA4 = 0x10,
+    WGFX_FONT_AA_MASK = 0x18, ///< The bits of the flags that store the coverage bits per pixel.
+} WGFXmonoFontFlags;
+
+/// A range of consecutive codepoints in a sparse `WGFXmonoFont` (see `WGFXmonoFont::ranges`).
+typedef struct
+{
+    /// The first codepoint in the range.
+    WGFX_U32 first;
+
+    /// The number of codepoints in the range.
+    WGFX_U16 count;
+
+    /// The index in the font's `data` of the character data for `first` (in characters, not bytes).
+    /// The following codepoints in the range have subsequent indices.
+    WGFX_U16 firstGlyph;
+} WGFXglyphRange;
+
 /// A monospaced bitmap font.
 typedef struct
 {
     /// Width and height of each character in the font.
     unsigned width, height;
 
-    /// First and last characters in the font (both inclusive).
+    /// First and last characters in the font (both inclusive). Ignored if `ranges` is set.
     char firstChar, lastChar;
 
     /// The stored character data.
@@ -23,14 +57,35 @@ typedef struct
     /// 3) Row pixels (one pixel per bit)
     /// Widths are rounded up to the nearest multiple of 8 bits
     /// (e.g.: for a font of width 13, 16 bits are used for each row).
+    /// If `flags & WGFX_FONT_PACKED`, rows are not padded instead: each character's bits are contiguous
+    /// (MSB first), and only each character's data starts on a new byte.
+    /// If `flags & WGFX_FONT_ROTATION_MASK`, each character is stored rotated instead: as a `height * width` character
+    /// (rotated by 90 or 270 degrees) or a `width * height` one (180 degrees), still in the format above.
+    /// If `flags & WGFX_FONT_AA_MASK`, each pixel takes 2 or 4 bits (MSB first) instead, and rows are `width * 2` or
+    /// `width * 4` bits long: stored as above, as if the font was that many pixels wide.
     /// `data` is assumed to point to a `WGFX_RODATA` variable; data from it is read
     /// by `WGFX_RODATA_READU8(data + offset)`.
     const WGFX_U8 *data;
 
     /// Number of bytes between two subsequent characters' pixel data in `data`.
-    /// Should be (`width` rounded to nearest multiple of 8) * `height`.
+    /// Should be (`width` rounded to nearest multiple of 8) / 8 * `height`,
+    /// or (`width * height` rounded to nearest multiple of 8) / 8 for `WGFX_FONT_PACKED` fonts
+    /// (with `width` and `height` swapped for fonts rotated by 90 or 270 degrees, and `width` multiplied by the bits
+    /// per pixel for anti-aliased fonts).
     WGFX_SIZET charDataStride;
 
+    /// Storage flags (0 for the default, padded format).
+    WGFXmonoFontFlags flags;
+
+    /// Optional, can be null: a table of `rangeCount` codepoint ranges, sorted by `first` and not overlapping.
+    /// If set, the font is sparse: it contains only the characters in these ranges (which can go beyond 255), and
+    /// `data` only stores their character data, in order. Codepoints are looked up by binary search.
+    /// Like `data`, it is assumed to point to a `WGFX_RODATA` variable.
+    const WGFXglyphRange *ranges;
+
+    /// The number of entries in `ranges`.
+    unsigned rangeCount;
+
 } WGFXmonoFont;
 
 #endif // WEEGFX_FONT_H
\ No newline at end of file
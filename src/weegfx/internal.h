@@ -0,0 +1,605 @@
+// weegfx/internal.h - Internal helpers shared by the weegfx core's translation units (not part of the public API!)
+// Copyright (c) 2019 Paolo Jovon <paolo.jovon@gmail.com>
+// Released under the 3-clause BSD license (see LICENSE)
+#ifndef WEEGFX_INTERNAL_H
+#define WEEGFX_INTERNAL_H
+
+#include "../weegfx.h"
+#include "kernels.h"
+
+#ifndef MIN
+#    define MIN(x, y) (((x) < (y)) ? (x) : (y))
+#endif
+#ifndef MAX
+#    define MAX(x, y) (((x) >= (y)) ? (x) : (y))
+#endif
+
+// -- Backend calls -----------------------------------------------------------------------------------------------------
+// All calls to the screen's callbacks go through these, so that they get counted in `WGFX_STATS` mode.
+
+#ifdef WGFX_STATS
+#    define WGFX_STATS_ADD(self, counter, n) ((self)->stats.counter += (WGFX_U32)(n))
+#    define WGFX_STATS_TIME(self, counter, call)                                   \
+        do                                                                         \
+        {                                                                          \
+            const WGFX_U32 statsStart_ = (self)->cycles ? (self)->cycles((self)->userPtr) : 0; \
+            call;                                                                  \
+            if((self)->cycles)                                                     \
+            {                                                                      \
+                (self)->stats.counter += (self)->cycles((self)->userPtr) - statsStart_; \
+            }                                                                      \
+        } while(0)
+#else
+#    define WGFX_STATS_ADD(self, counter, n) ((void)0)
+#    define WGFX_STATS_TIME(self, counter, call) call
+#endif
+
+WGFX_FORCEINLINE static void screenBackendBeginWrite(WGFXscreen *self, unsigned x, unsigned y, unsigned w, unsigned h)
+{
+    WGFX_STATS_ADD(self, beginWrites, 1);
+    WGFX_STATS_TIME(self, backendCycles, self->beginWrite(x, y, w, h, self->userPtr));
+}
+
+WGFX_FORCEINLINE static void screenBackendWrite(WGFXscreen *self, const WGFX_U8 *buf, WGFX_SIZET size)
+{
+    WGFX_STATS_ADD(self, writes, 1);
+    WGFX_STATS_ADD(self, bytesWritten, size);
+    WGFX_STATS_ADD(self, scratchBytes, ((self->flags & WGFX_SCREEN_DOUBLE_BUFFER) ? self->scratchSize / 2 : self->scratchSize) * self->bpp);
+    WGFX_STATS_TIME(self, backendCycles, self->write(buf, size, self->userPtr));
+}
+
+WGFX_FORCEINLINE static void screenBackendEndWrite(WGFXscreen *self)
+{
+    WGFX_STATS_TIME(self, backendCycles, self->endWrite(self->userPtr));
+}
+
+WGFX_FORCEINLINE static void screenWaitWrite(WGFXscreen *self, const WGFX_U8 *buf)
+{
+    if(self->waitWrite)
+    {
+        WGFX_STATS_TIME(self, waitCycles, self->waitWrite(buf, self->userPtr));
+    }
+}
+
+WGFX_FORCEINLINE static void screenScroll(WGFXscreen *self, unsigned top, unsigned height, unsigned offset)
+{
+    WGFX_STATS_TIME(self, backendCycles, self->scroll(top, height, offset, self->userPtr));
+}
+
+// -- Rotation ----------------------------------------------------------------------------------------------------------
+
+/// Maps the `*w * *h` rectangle at `*x`, `*y` of a `width * height` area, as seen with `rotation`, to where it is in
+/// the area as stored (i.e. unrotated). Its pixels are stored in the order given by `rotatedRow()`.
+WGFX_FORCEINLINE static void rotateRect(WGFXrotation rotation, unsigned width, unsigned height,
+                                        unsigned *x, unsigned *y, unsigned *w, unsigned *h)
+{
+    const unsigned x0 = *x, y0 = *y, w0 = *w, h0 = *h;
+    switch(rotation)
+    {
+    case WGFX_ROTATE_90:
+        *x = height - (y0 + h0);
+        *y = x0;
+        *w = h0;
+        *h = w0;
+        break;
+    case WGFX_ROTATE_180:
+        *x = width - (x0 + w0);
+        *y = height - (y0 + h0);
+        break;
+    case WGFX_ROTATE_270:
+        *x = y0;
+        *y = width - (x0 + w0);
+        *w = h0;
+        *h = w0;
+        break;
+    default:
+        break;
+    }
+}
+
+/// Given a `w * h` block of `bpp`-bytes pixels as seen with `rotation` (rows `stride` bytes apart), returns the pixel
+/// stored first on row `row` of the block as stored (see `rotateRect()`); the next pixels of that row are `*step` bytes
+/// apart from each other in the block.
+WGFX_FORCEINLINE static const WGFX_U8 *rotatedRow(WGFXrotation rotation, const WGFX_U8 *block, WGFX_SIZET stride,
+                                                 unsigned bpp, unsigned w, unsigned h, unsigned row, long *step)
+{
+    switch(rotation)
+    {
+    case WGFX_ROTATE_90:
+        // (stored rows are columns, bottom to top)
+        *step = -(long)stride;
+        return block + (h - 1) * stride + (WGFX_SIZET)row * bpp;
+    case WGFX_ROTATE_180:
+        *step = -(long)bpp;
+        return block + (h - 1 - row) * stride + (WGFX_SIZET)(w - 1) * bpp;
+    case WGFX_ROTATE_270:
+        // (stored rows are columns right to left, each top to bottom)
+        *step = (long)stride;
+        return block + (WGFX_SIZET)(w - 1 - row) * bpp;
+    default:
+        *step = (long)bpp;
+        return block + row * stride;
+    }
+}
+
+/// Returns the rotation a font's glyphs are stored with (see `WGFX_FONT_ROTATION_MASK`).
+WGFX_FORCEINLINE static WGFXrotation monoFontRotation(const WGFXmonoFont *font)
+{
+    return (WGFXrotation)((font->flags & WGFX_FONT_ROTATION_MASK) >> 1);
+}
+
+/// Returns the bits per pixel of a font's glyphs: 1, or 2/4 for anti-aliased fonts (see `WGFX_FONT_AA_MASK`).
+WGFX_FORCEINLINE static unsigned monoFontPixelBits(const WGFXmonoFont *font)
+{
+#ifdef WGFX_NO_AA_FONTS
+    (void)font;
+    return 1; // (anti-aliased fonts are rejected by `monoFontSupported()`, so that their code can be dropped)
+#else
+    return (font->flags & WGFX_FONT_AA4) ? 4 : (font->flags & WGFX_FONT_AA2) ? 2 : 1;
+#endif
+}
+
+/// Returns false if text in `font` cannot be drawn (i.e. it is anti-aliased and `WGFX_NO_AA_FONTS` is defined).
+WGFX_FORCEINLINE static int monoFontSupported(const WGFXmonoFont *font)
+{
+#ifdef WGFX_NO_AA_FONTS
+    return !(font->flags & WGFX_FONT_AA_MASK);
+#else
+    (void)font;
+    return 1;
+#endif
+}
+
+/// `WGFXscreen::rotateState` bits.
+enum
+{
+    WGFX_ROTATE_REORDERING = 0x1,  ///< The window's pixels are written as drawn, and have to be reordered.
+    WGFX_ROTATE_WINDOW_OPEN = 0x2, ///< A window of reordered pixels was begun on the backend, but not ended yet.
+};
+
+/// Begins a write of the `w * h` window at `x`, `y` (as drawn to) on a rotated screen, whose pixels are to be reordered.
+/// (Defined in weegfx.c)
+void wgfxBeginRotatedWrite(WGFXscreen *self, unsigned x, unsigned y, unsigned w, unsigned h);
+
+/// Reorders pixels written to a window begun by `wgfxBeginRotatedWrite()`, writing them to the backend.
+/// (Defined in weegfx.c)
+void wgfxRotatedWrite(WGFXscreen *self, const WGFX_U8 *buf, WGFX_SIZET size);
+
+/// Ends a window begun by `wgfxBeginRotatedWrite()`.
+/// (Defined in weegfx.c)
+void wgfxEndRotatedWrite(WGFXscreen *self);
+
+// -- Screen writes -----------------------------------------------------------------------------------------------------
+// Windows are given as drawn to, and pixels are written in row-major order; on a rotated screen, they are reordered.
+
+WGFX_FORCEINLINE static void screenBeginWrite(WGFXscreen *self, unsigned x, unsigned y, unsigned w, unsigned h)
+{
+    if(self->rotation != WGFX_ROTATE_0)
+    {
+        wgfxBeginRotatedWrite(self, x, y, w, h);
+        return;
+    }
+    screenBackendBeginWrite(self, x, y, w, h);
+}
+
+/// Like `screenBeginWrite()`, but the caller writes the window's pixels in the order the screen stores them in (see
+/// `rotateRect()`) instead, so that they need no reordering: for solid fills, or for kernels that render rotated.
+WGFX_FORCEINLINE static void screenBeginWriteRotated(WGFXscreen *self, unsigned x, unsigned y, unsigned w, unsigned h)
+{
+    rotateRect(self->rotation, self->width, self->height, &x, &y, &w, &h);
+    self->rotateState = 0;
+    screenBackendBeginWrite(self, x, y, w, h);
+}
+
+WGFX_FORCEINLINE static void screenWrite(WGFXscreen *self, const WGFX_U8 *buf, WGFX_SIZET size)
+{
+    if(self->rotateState & WGFX_ROTATE_REORDERING)
+    {
+        wgfxRotatedWrite(self, buf, size);
+        return;
+    }
+    screenBackendWrite(self, buf, size);
+}
+
+/// Returns false if there is no `writeRepeat()`, or if it refused to repeat `pixel`
+/// (or if the window's pixels are being reordered; begin it with `screenBeginWriteRotated()` instead).
+WGFX_FORCEINLINE static int screenWriteRepeat(WGFXscreen *self, const WGFX_U8 *pixel, WGFX_SIZET count)
+{
+    if(!self->writeRepeat || (self->rotateState & WGFX_ROTATE_REORDERING))
+    {
+        return 0;
+    }
+    int written;
+    WGFX_STATS_TIME(self, backendCycles, written = self->writeRepeat(pixel, count, self->userPtr));
+    if(written)
+    {
+        WGFX_STATS_ADD(self, writes, 1);
+        WGFX_STATS_ADD(self, bytesWritten, count * self->bpp);
+    }
+    return written;
+}
+
+WGFX_FORCEINLINE static void screenEndWrite(WGFXscreen *self)
+{
+    if(self->rotateState & WGFX_ROTATE_REORDERING)
+    {
+        wgfxEndRotatedWrite(self);
+        return;
+    }
+    screenBackendEndWrite(self);
+}
+
+// -- Clipping ----------------------------------------------------------------------------------------------------------
+
+/// Intersects the `*w * *h` rectangle at `*x`, `*y` with the current clip rectangle (the last one pushed with
+/// `wgfxPushClip()`, or the whole screen). Returns false if the intersection is empty.
+/// If not null, `*dx` and `*dy` are set to how many columns/rows were cut off from the left/top of the rectangle.
+inline static int clipRect(const WGFXscreen *self, unsigned *x, unsigned *y, unsigned *w, unsigned *h,
+                           unsigned *dx, unsigned *dy)
+{
+    unsigned cutX = 0, cutY = 0;
+#ifndef WGFX_NO_CLIPPING
+    unsigned clipX = 0, clipY = 0, clipX1 = self->width, clipY1 = self->height;
+    if(self->clipDepth > 0)
+    {
+        const WGFXrect *const clip = &self->clipStack[self->clipDepth - 1];
+        clipX = clip->x;
+        clipY = clip->y;
+        clipX1 = clip->x + clip->w;
+        clipY1 = clip->y + clip->h;
+    }
+    cutX = (*x < clipX) ? clipX - *x : 0;
+    cutY = (*y < clipY) ? clipY - *y : 0;
+    const unsigned x0 = *x + cutX, y0 = *y + cutY;
+    const unsigned x1 = MIN(*x + *w, clipX1), y1 = MIN(*y + *h, clipY1);
+    if(x0 >= x1 || y0 >= y1)
+    {
+        *w = *h = 0;
+    }
+    else
+    {
+        *x = x0;
+        *y = y0;
+        *w = x1 - x0;
+        *h = y1 - y0;
+    }
+#else
+    (void)self;
+    (void)x;
+    (void)y;
+#endif
+    if(dx)
+    {
+        *dx = cutX;
+    }
+    if(dy)
+    {
+        *dy = cutY;
+    }
+    return *w != 0 && *h != 0;
+}
+
+// -- Scratch buffer ----------------------------------------------------------------------------------------------------
+
+/// Returns the number of pixels that can be rendered to the scratch buffer at once
+/// (the whole of it, or one half in `WGFX_SCREEN_DOUBLE_BUFFER` mode).
+WGFX_FORCEINLINE static WGFX_SIZET scratchPixels(const WGFXscreen *self)
+{
+    return (self->flags & WGFX_SCREEN_DOUBLE_BUFFER) ? self->scratchSize / 2 : self->scratchSize;
+}
+
+/// Returns the part of the scratch buffer to render to next, waiting for the screen to be done reading
+/// from it if needed. In `WGFX_SCREEN_DOUBLE_BUFFER` mode this alternates between the two halves.
+inline static WGFX_U8 *acquireScratch(WGFXscreen *self)
+{
+    WGFX_U8 *scratch = self->scratchData;
+    if(self->flags & WGFX_SCREEN_DOUBLE_BUFFER)
+    {
+        if(self->scratchHalf)
+        {
+            scratch += (self->scratchSize / 2) * self->bpp;
+        }
+        self->scratchHalf = !self->scratchHalf;
+    }
+    screenWaitWrite(self, scratch);
+    return scratch;
+}
+
+/// On a rotated screen, lets the pixels of the window begun by `screenBeginWrite()` be reordered into what is left of
+/// the scratch region of `scratch` (see `wgfxWaitWriteRegion()`) after its first `usedSizeB` bytes, instead of a small
+/// buffer on the stack, if the screen has no `rotateData`. That part must be left alone until the window is ended.
+WGFX_FORCEINLINE static void screenReorderIntoScratch(WGFXscreen *self, WGFX_U8 *scratch, WGFX_SIZET usedSizeB)
+{
+    if(!(self->rotateState & WGFX_ROTATE_REORDERING))
+    {
+        return;
+    }
+    const WGFX_U8 *begin, *end;
+    wgfxWaitWriteRegion(self, scratch, &begin, &end);
+    const WGFX_SIZET regionSizeB = (WGFX_SIZET)(end - scratch);
+    self->rotateSpare = scratch + usedSizeB;
+    self->rotateSpareSize = (usedSizeB < regionSizeB) ? regionSizeB - usedSizeB : 0;
+}
+
+/// The state of a batch of rectangle fills: what the scratch buffer was last filled with.
+typedef struct
+{
+    /// The part of the scratch buffer holding `filledCount` pixels of `color`; null if none was acquired yet.
+    WGFX_U8 *scratch;
+    WGFX_SIZET filledCount;
+    WGFXcolor color;
+} WGFXfillBatch;
+
+/// Fills the `w * h` rectangle at `x`, `y` (already clipped, not empty) with `color`.
+/// Only refills the scratch buffer when `color` changes, or when more of it is needed than what was filled already;
+/// zero-initialize `batch` before the first fill.
+/// (Defined in weegfx.c)
+void wgfxBatchFillRect(WGFXscreen *self, WGFXfillBatch *batch, unsigned x, unsigned y, unsigned w, unsigned h,
+                       const WGFXcolor color);
+
+// -- Monospace text ----------------------------------------------------------------------------------------------------
+
+/// <string.h>-less strlen
+inline static unsigned stringLength(const char *string)
+{
+    const char *iCh = string;
+    while(*iCh)
+    {
+        iCh++;
+    }
+    return (unsigned)(iCh - string);
+}
+
+struct WGFXmonoTextCtx;
+
+/// A function that renders the top-left `width * height` rectangle of a character (whose font data is at `data`)
+/// to a data `buffer`, whose rows are `rowStride` bytes apart; see `WGFXmonoTextCtx`.
+/// Does NOT even try to perform any clipping or bounds checking!
+typedef void (*WGFXmonoCharWriterPFN)(const struct WGFXmonoTextCtx *ctx, const WGFX_U8 *data,
+                                      WGFX_U8 *buffer, unsigned rowStride, unsigned width, unsigned height);
+
+/// State shared by all characters rendered in one monospace text drawing call.
+/// Picks the fastest character writers for the font/scale/bpp combination once, so that the per-pixel loops
+/// do not branch on them.
+typedef struct WGFXmonoTextCtx
+{
+    const WGFXmonoFont *font;
+    unsigned bpp, scale;
+    unsigned charWidth, charHeight; //< (scaled)
+    const WGFX_U8 *fgColor, *bgColor;
+
+    /// Writer for whole (`charWidth`-wide) characters.
+    WGFXmonoCharWriterPFN writeChar;
+    /// Writer for characters clipped on the right.
+    WGFXmonoCharWriterPFN writeClippedChar;
+
+#ifndef WGFX_NO_GLYPH_LUT
+    /// Expands fg/bg colors; only initialized if used by the writers.
+    WGFXnibbleLUT lut;
+#endif
+
+    /// The color of each pixel value of the font (see `monoGlyphPixel()`): `bgColor`, then `fgColor` for 1-bit fonts;
+    /// from `bgColor` to `fgColor` for anti-aliased ones, whose shades in between are blended once in `shadeData`
+    /// (with `blend`, passed `blendUserPtr`; or byte by byte if null). Only `fgColor` is set for transparent text.
+#ifndef WGFX_NO_AA_FONTS
+    const WGFX_U8 *shades[16];
+    WGFX_U8 shadeData[16][WGFX_MAX_BPP];
+    WGFXblendPFN blend;
+    void *blendUserPtr;
+#else
+    const WGFX_U8 *shades[2];
+#endif
+
+    /// The screen's glyph cache, or null if characters are not to be cached; the cache keys of `fgColor`, `bgColor`,
+    /// and the screen's `blend` function (null for fonts that are not anti-aliased, whose pixels are never blended).
+    WGFXglyphCache *cache;
+    WGFX_U32 fgKey, bgKey;
+    WGFXblendPFN blendKey;
+} WGFXmonoTextCtx;
+
+/// Returns the font data of codepoint `cp` in a sparse font (one with `ranges`), or null if it is not in the font.
+/// (Defined in weegfx.c)
+const WGFX_U8 *wgfxSparseGlyphData(const WGFXmonoFont *font, WGFX_U32 cp);
+
+/// Returns the font data of codepoint `cp` in `font`, or null if it is not in the font.
+/// (For plain `char`s, pass `(unsigned char)ch`).
+WGFX_FORCEINLINE static const WGFX_U8 *monoGlyphData(const WGFXmonoFont *font, WGFX_U32 cp)
+{
+    if(font->ranges)
+    {
+        return wgfxSparseGlyphData(font, cp);
+    }
+    const WGFX_U32 firstChar = (unsigned char)font->firstChar, lastChar = (unsigned char)font->lastChar;
+    if(firstChar <= cp && cp <= lastChar)
+    {
+        return font->data + ((WGFX_SIZET)(cp - firstChar) * font->charDataStride);
+    }
+    return 0;
+}
+
+/// Decodes the next codepoint in a string (that ends at `strEnd`), advancing `*iCh` past it.
+/// If `utf8`, the string is UTF-8 encoded (invalid sequences decode to U+FFFD); otherwise, each `char` is a codepoint.
+WGFX_FORCEINLINE static WGFX_U32 nextCodepoint(const char **iCh, const char *strEnd, int utf8)
+{
+    const WGFX_U32 lead = (unsigned char)*(*iCh)++;
+    if(!utf8 || lead < 0x80)
+    {
+        return lead;
+    }
+
+    unsigned nCont;
+    WGFX_U32 cp, minCp;
+    if((lead & 0xE0) == 0xC0)
+    {
+        nCont = 1;
+        cp = lead & 0x1F;
+        minCp = 0x80;
+    }
+    else if((lead & 0xF0) == 0xE0)
+    {
+        nCont = 2;
+        cp = lead & 0x0F;
+        minCp = 0x800;
+    }
+    else if((lead & 0xF8) == 0xF0)
+    {
+        nCont = 3;
+        cp = lead & 0x07;
+        minCp = 0x10000;
+    }
+    else
+    {
+        return 0xFFFD; // Stray continuation byte or invalid lead byte
+    }
+
+    for(unsigned i = 0; i < nCont; i++)
+    {
+        if(*iCh >= strEnd || ((unsigned char)**iCh & 0xC0) != 0x80)
+        {
+            return 0xFFFD; // Truncated sequence (the next byte is decoded on its own)
+        }
+        cp = (cp << 6) | ((unsigned char)*(*iCh)++ & 0x3F);
+    }
+    const int invalid = cp < minCp || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF); // (overlong, out of range, surrogate)
+    return invalid ? 0xFFFD : cp;
+}
+
+/// Returns the number of codepoints in the `length` bytes of `string` (see `nextCodepoint()`).
+inline static WGFX_SIZET countCodepoints(const char *string, WGFX_SIZET length, int utf8)
+{
+    if(!utf8)
+    {
+        return length;
+    }
+    const char *const strEnd = string + length;
+    WGFX_SIZET count = 0;
+    while(string < strEnd)
+    {
+        nextCodepoint(&string, strEnd, utf8);
+        count++;
+    }
+    return count;
+}
+
+/// Returns the value of the pixel at `col`, `row` (unscaled) of a character whose font data is at `data`: 0 or 1, or
+/// its coverage for anti-aliased fonts (0 to `(1 << monoFontPixelBits(font)) - 1`).
+WGFX_FORCEINLINE static unsigned monoGlyphPixel(const WGFXmonoFont *font, const WGFX_U8 *data, unsigned col, unsigned row)
+{
+    const unsigned pixelBits = monoFontPixelBits(font), rowBits = font->width * pixelBits;
+    const unsigned bitsPerRow = (font->flags & WGFX_FONT_PACKED) ? rowBits : (rowBits + 7) & ~0x7u;
+    const WGFX_SIZET bit = (WGFX_SIZET)row * bitsPerRow + col * pixelBits; //< (pixels never straddle two bytes)
+    return (WGFX_RODATA_READU8(data + bit / 8) >> (8 - pixelBits - bit % 8)) & ((1u << pixelBits) - 1);
+}
+
+/// Reads a stream of bits (MSB first) from `WGFX_RODATA`, one byte load per 8 bits.
+/// Used for `WGFX_FONT_PACKED` fonts, whose rows do not start on byte boundaries.
+typedef struct
+{
+    const WGFX_U8 *data; ///< The next byte to load.
+    unsigned byte;       ///< The last loaded byte, shifted so that its next bit is bit 7.
+    unsigned bitsLeft;   ///< The number of bits of `byte` not read yet.
+} WGFXbitReader;
+
+inline static void initBitReader(WGFXbitReader *reader, const WGFX_U8 *data)
+{
+    reader->data = data;
+    reader->byte = 0;
+    reader->bitsLeft = 0;
+}
+
+/// Reads the next `n` (1 to 8) bits; they are returned in the lowest bits of the result.
+WGFX_FORCEINLINE static unsigned readBits(WGFXbitReader *reader, unsigned n)
+{
+    if(n <= reader->bitsLeft)
+    {
+        const unsigned bits = (reader->byte & 0xFF) >> (8 - n);
+        reader->byte <<= n;
+        reader->bitsLeft -= n;
+        return bits;
+    }
+
+    // Take the bits left (if any), then the rest from the next byte
+    const unsigned have = reader->bitsLeft, need = n - have;
+    const unsigned next = WGFX_RODATA_READU8(reader->data++);
+    const unsigned bits = (((reader->byte & 0xFF) >> (8 - have)) << need) | (next >> (8 - need));
+    reader->byte = next << need;
+    reader->bitsLeft = 8 - need;
+    return bits;
+}
+
+/// Skips the next `n` bits (any amount).
+inline static void skipBits(WGFXbitReader *reader, WGFX_SIZET n)
+{
+    if(n <= reader->bitsLeft)
+    {
+        reader->byte <<= n;
+        reader->bitsLeft -= (unsigned)n;
+        return;
+    }
+    n -= reader->bitsLeft;
+    reader->data += n / 8;
+    reader->bitsLeft = 0;
+    if(n % 8)
+    {
+        readBits(reader, (unsigned)(n % 8));
+    }
+}
+
+/// Inits `ctx` for drawing text in `font` with the given parameters, picking the character writers to use.
+/// (Defined in weegfx.c)
+void wgfxInitMonoTextCtx(WGFXmonoTextCtx *ctx, const WGFXscreen *self, const WGFXmonoFont *font, unsigned scale,
+                         const WGFXcolor fgColor, const WGFXcolor bgColor);
+
+/// Renders the `nCols * nRows` rectangle of a character whose top-left corner is at `col0`, `row0` (scaled, relative
+/// to the character's top-left corner) to a data `buffer`, whose rows are `rowStride` bytes apart.
+/// `data` is the character's font data, or null for missing characters (that are left blank).
+/// If `transparent`, only foreground pixels are written; `ctx->bgColor` can be null in this case.
+/// (Defined in weegfx.c)
+void wgfxCompositeMonoChar(const WGFXmonoTextCtx *ctx, const WGFX_U8 *data, WGFX_U8 *buffer, unsigned rowStride,
+                           unsigned col0, unsigned nCols, unsigned row0, unsigned nRows, int transparent);
+
+/// Returns the pixels of codepoint `cp` (a whole `charWidth * charHeight` character) from `ctx->cache`, rendering
+/// and caching it first if it is not there yet. `ctx->cache` must not be null.
+/// (Defined in weegfx.c)
+const WGFX_U8 *wgfxCachedGlyph(const WGFXmonoTextCtx *ctx, WGFX_U32 cp);
+
+/// Renders the top-left `width * height` rectangle of codepoint `cp` (with `width` and `height` already scaled)
+/// to a data `buffer`, whose rows are `rowStride` bytes apart. Characters missing from the font are left blank.
+/// Does NOT even try to perform any clipping or bounds checking!
+WGFX_FORCEINLINE static void writeMonoChar(const WGFXmonoTextCtx *ctx, WGFX_U32 cp,
+                                           WGFX_U8 *buffer, unsigned rowStride, unsigned width, unsigned height)
+{
+    if(ctx->cache)
+    {
+        // Cached: just copy the pixels
+        const WGFX_U8 *cached = wgfxCachedGlyph(ctx, cp);
+        const unsigned cachedRowStride = ctx->charWidth * ctx->bpp, rowBytes = width * ctx->bpp;
+        for(unsigned row = 0; row < height; row++)
+        {
+            WGFX_MEMCPY(buffer, cached, rowBytes);
+            buffer += rowStride;
+            cached += cachedRowStride;
+        }
+        return;
+    }
+
+    const WGFX_U8 *const data = monoGlyphData(ctx->font, cp);
+    if(!data)
+    {
+        for(unsigned row = 0; row < height; row++)
+        {
+            fillPixels(buffer, ctx->bgColor, ctx->bpp, width);
+            buffer += rowStride;
+        }
+    }
+    else if(width == ctx->charWidth)
+    {
+        ctx->writeChar(ctx, data, buffer, rowStride, width, height);
+    }
+    else
+    {
+        ctx->writeClippedChar(ctx, data, buffer, rowStride, width, height);
+    }
+}
+
+#endif // WEEGFX_INTERNAL_H
@@ -0,0 +1,233 @@
+// weegfx/kernels.h - Internal pixel kernels used by the weegfx core (not part of the public API!)
+// Copyright (c) 2019 Paolo Jovon <paolo.jovon@gmail.com>
+// Released under the 3-clause BSD license (see LICENSE)
+#ifndef WEEGFX_KERNELS_H
+#define WEEGFX_KERNELS_H
+
+#include "base.h"
+#include "types.h"
+
+// `WGFX_FIXED_BPP`: #define it to the bytes per pixel of all screens (1 to 4) to make the kernels below use
+// a compile-time constant instead of the `bpp` passed to them; the compiler can then drop all other variants.
+#if defined(WGFX_FIXED_BPP) && (WGFX_FIXED_BPP < 1 || WGFX_FIXED_BPP > 4)
+#    error "WGFX_FIXED_BPP must be between 1 and 4"
+#endif
+
+#ifdef WGFX_FIXED_BPP
+#    define WGFX_KERNEL_BPP(bpp) ((void)(bpp), WGFX_FIXED_BPP)
+#else
+#    define WGFX_KERNEL_BPP(bpp) (bpp)
+#endif
+
+// A 32-bit word that can be used to access memory of any type (i.e. the scratch buffer's bytes).
+#if defined(__GNUC__) || defined(__clang__)
+typedef WGFX_U32 __attribute__((may_alias)) WGFXword;
+#else
+typedef WGFX_U32 WGFXword;
+#endif
+
+/// Copies a single `bpp`-bytes pixel from `color` to `dst`.
+WGFX_FORCEINLINE static void copyPixel(WGFX_U8 *dst, const WGFX_U8 *color, unsigned bpp)
+{
+    switch(WGFX_KERNEL_BPP(bpp))
+    {
+    case 4:
+        dst[3] = color[3];
+        // fallthrough
+    case 3:
+        dst[2] = color[2];
+        // fallthrough
+    case 2:
+        dst[1] = color[1];
+        // fallthrough
+    case 1:
+        dst[0] = color[0];
+        break;
+    default:
+        WGFX_MEMCPY(dst, color, bpp);
+        break;
+    }
+}
+
+/// Fills `size` bytes at `dst` with `pattern` (a 4-byte pattern, repeated), using aligned word-wide stores
+/// where possible. `pattern` must be a whole number of pixels (i.e. only valid for 1, 2 and 4 bpp).
+inline static void fillPattern32(WGFX_U8 *dst, const WGFX_U8 pattern[4], WGFX_SIZET size)
+{
+    WGFX_U8 *const end = dst + size;
+
+    // Head: write bytes until `dst` is aligned
+    unsigned phase = 0;
+    while(((WGFX_SIZET)dst & 0x3) && dst < end)
+    {
+        *dst++ = pattern[phase];
+        phase = (phase + 1) & 0x3;
+    }
+
+    // Body: the pattern, rotated to match the alignment, written a word at a time
+    WGFX_U8 rotated[4];
+    for(unsigned i = 0; i < 4; i++)
+    {
+        rotated[i] = pattern[(phase + i) & 0x3];
+    }
+    WGFXword word;
+    WGFX_MEMCPY(&word, rotated, sizeof(word));
+
+    while((WGFX_SIZET)(end - dst) >= 4 * sizeof(word))
+    {
+        ((WGFXword *)dst)[0] = word;
+        ((WGFXword *)dst)[1] = word;
+        ((WGFXword *)dst)[2] = word;
+        ((WGFXword *)dst)[3] = word;
+        dst += 4 * sizeof(word);
+    }
+    while((WGFX_SIZET)(end - dst) >= sizeof(word))
+    {
+        *(WGFXword *)dst = word;
+        dst += sizeof(word);
+    }
+
+    // Tail
+    for(unsigned i = 0; dst < end; i++)
+    {
+        *dst++ = rotated[i];
+    }
+}
+
+/// Fills `count` pixels at `dst` with `color` by copying the first pixel, then doubling the filled region
+/// with `WGFX_MEMCPY()` until done. Works for any `bpp`.
+inline static void fillDoubling(WGFX_U8 *dst, const WGFX_U8 *color, unsigned bpp, WGFX_SIZET count)
+{
+    if(count == 0)
+    {
+        return;
+    }
+
+    copyPixel(dst, color, bpp);
+    const WGFX_SIZET sizeB = count * bpp;
+    WGFX_SIZET filledB = bpp;
+    while(filledB * 2 <= sizeB)
+    {
+        WGFX_MEMCPY(dst + filledB, dst, filledB);
+        filledB *= 2;
+    }
+    WGFX_MEMCPY(dst + filledB, dst, sizeB - filledB);
+}
+
+/// Fills `count` pixels at `dst` with `color` (a `bpp`-bytes pixel), picking the fastest kernel for `bpp`.
+WGFX_FORCEINLINE static void fillPixels(WGFX_U8 *dst, const WGFX_U8 *color, unsigned bpp, WGFX_SIZET count)
+{
+    WGFX_U8 pattern[4];
+    switch(WGFX_KERNEL_BPP(bpp))
+    {
+    case 1:
+        WGFX_MEMSET(dst, color[0], count);
+        break;
+    case 2:
+        // RGB565 & co.: replicate the pixel twice in a 32-bit pattern
+        pattern[0] = pattern[2] = color[0];
+        pattern[1] = pattern[3] = color[1];
+        fillPattern32(dst, pattern, count * 2);
+        break;
+    case 4:
+        WGFX_MEMCPY(pattern, color, 4);
+        fillPattern32(dst, pattern, count * 4);
+        break;
+    default:
+        fillDoubling(dst, color, WGFX_KERNEL_BPP(bpp), count);
+        break;
+    }
+}
+
+// `WGFX_MAX_BPP`: the maximum bytes per pixel supported by lookup-table kernels (defaults to `WGFX_FIXED_BPP`, or 4).
+// Lookup tables take `16 * 4 * WGFX_MAX_BPP` bytes of stack; screens with a bigger `bpp` use slower, table-less code.
+// `WGFX_NO_GLYPH_LUT`: #define it to never use lookup tables (to save stack space on very small MCUs).
+// `WGFX_NO_AA_FONTS`: #define it to drop support for anti-aliased fonts (see `WGFX_FONT_AA2`); text drawing calls then
+// only keep the 2 colors of 1-bit fonts instead of a table of 16 blended shades, that takes `16 * WGFX_MAX_BPP` bytes
+// plus 16 pointers of stack. Drawing text in anti-aliased fonts fails.
+#ifndef WGFX_MAX_BPP
+#    ifdef WGFX_FIXED_BPP
+#        define WGFX_MAX_BPP WGFX_FIXED_BPP
+#    else
+#        define WGFX_MAX_BPP 4
+#    endif
+#endif
+
+/// A lookup table that expands a nibble of 1-bit-per-pixel data (MSB first) to 4 pixels, a color for set bits
+/// and one for clear bits. When upscaling, each entry can instead expand 2 bits (x2) or 1 bit (x4) to 4 pixels.
+typedef struct
+{
+    /// The 4 pixels for each nibble value, `bpp` bytes each.
+    WGFX_U8 pixels[16][4 * WGFX_MAX_BPP];
+} WGFXnibbleLUT;
+
+/// Fills `lut` so that it expands bits to `onColor` (for set bits) and `offColor` (for clear bits) pixels.
+/// `scale` must be 1, 2 or 4: each entry of the table expands `4 / scale` bits, each repeated `scale` times.
+inline static void initNibbleLUT(WGFXnibbleLUT *lut, const WGFX_U8 *onColor, const WGFX_U8 *offColor, unsigned bpp,
+                                 unsigned scale)
+{
+    const unsigned entryBits = 4 / scale;
+    for(unsigned entry = 0; entry < (1u << entryBits); entry++)
+    {
+        WGFX_U8 *dst = lut->pixels[entry];
+        for(unsigned pixel = 0; pixel < 4; pixel++)
+        {
+            const unsigned bit = entryBits - 1 - pixel / scale;
+            copyPixel(dst, ((entry >> bit) & 0x1) ? onColor : offColor, bpp);
+            dst += bpp;
+        }
+    }
+}
+
+/// Copies `count` (<= 4) pixels for the `nibble` entry of `lut` to `dst`. Returns `dst` advanced past the copied pixels.
+WGFX_FORCEINLINE static WGFX_U8 *copyNibblePixels(WGFX_U8 *dst, const WGFXnibbleLUT *lut, unsigned nibble,
+                                                 unsigned bpp, unsigned count)
+{
+    bpp = WGFX_KERNEL_BPP(bpp);
+    if(count == 4)
+    {
+        // (fixed-size copies, so that the compiler can turn them into a couple of loads/stores)
+        switch(bpp)
+        {
+        case 1:
+            WGFX_MEMCPY(dst, lut->pixels[nibble], 4 * 1);
+            break;
+        case 2:
+            WGFX_MEMCPY(dst, lut->pixels[nibble], 4 * 2);
+            break;
+#    if WGFX_MAX_BPP >= 3
+        case 3:
+            WGFX_MEMCPY(dst, lut->pixels[nibble], 4 * 3);
+            break;
+#    endif
+#    if WGFX_MAX_BPP >= 4
+        case 4:
+            WGFX_MEMCPY(dst, lut->pixels[nibble], 4 * 4);
+            break;
+#    endif
+        default:
+            WGFX_MEMCPY(dst, lut->pixels[nibble], 4 * bpp);
+            break;
+        }
+    }
+    else
+    {
+        WGFX_MEMCPY(dst, lut->pixels[nibble], count * bpp);
+    }
+    return dst + count * bpp;
+}
+
+/// Given that `buffer` points to a row of `rowBytes` bytes, copies it to the subsequent `nRows - 1` rows
+/// (`rowStride` bytes apart), i.e. upscales it vertically. Returns a pointer to the start of the row after them.
+WGFX_FORCEINLINE static WGFX_U8 *repeatRow(WGFX_U8 *buffer, unsigned rowStride, unsigned rowBytes, unsigned nRows)
+{
+    WGFX_U8 *const row = buffer;
+    buffer += rowStride;
+    for(unsigned i = 1; i < nRows; i++)
+    {
+        WGFX_MEMCPY(buffer, row, rowBytes);
+        buffer += rowStride;
+    }
+    return buffer;
+}
+
+#endif // WEEGFX_KERNELS_H
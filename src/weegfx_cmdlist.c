@@ -0,0 +1,333 @@
+// weegfx_cmdlist.c - Display lists and banded rendering for weegfx.
+// Copyright (c) 2019 Paolo Jovon <paolo.jovon@gmail.com>
+// Released under the 3-clause BSD license (see LICENSE)
+#include "weegfx.h"
+
+#include "weegfx/internal.h"
+#include "weegfx/kernels.h"
+
+/// Appends a new command of the given type and bounding rect to the list.
+/// Returns it, or null if the list is full.
+static WGFXcmd *pushCmd(WGFXcmdList *list, WGFXcmdType type, unsigned x, unsigned y, unsigned w, unsigned h)
+{
+    if(list->count >= list->capacity)
+    {
+        return 0;
+    }
+    WGFXcmd *cmd = &list->cmds[list->count++];
+    cmd->type = type;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->w = w;
+    cmd->h = h;
+    return cmd;
+}
+
+void wgfxCmdListInvalidate(WGFXcmdList *list)
+{
+    for(unsigned i = 0; i < list->bandHashCount; i++)
+    {
+        list->bandHashes[i] = 0;
+    }
+}
+
+int wgfxCmdFillRect(WGFXcmdList *list, unsigned x, unsigned y, unsigned w, unsigned h, const WGFXcolor color)
+{
+    WGFXcmd *cmd = pushCmd(list, WGFX_CMD_FILL_RECT, x, y, w, h);
+    if(!cmd)
+    {
+        return 0;
+    }
+
+    cmd->color = color;
+    return 1;
+}
+
+int wgfxCmdTextMono(WGFXcmdList *list, const char *string, unsigned length, unsigned x, unsigned y,
+                    const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor, WGFXwrapMode wrapMode)
+{
+    if(!monoFontSupported(font))
+    {
+        return 0;
+    }
+    length = (length == 0) ? stringLength(string) : length;
+    scale = (scale > 1) ? scale : 1;
+
+    // Measure the text (only wrapping on '\n' is supported)
+    unsigned maxChars = 0, lineChars = 0, nLines = 1;
+    for(unsigned i = 0; i < length; i++)
+    {
+        if(string[i] == '\n' && (wrapMode & WGFX_WRAP_NEWLINE))
+        {
+            nLines++;
+            lineChars = 0;
+        }
+        else
+        {
+            lineChars++;
+            maxChars = MAX(maxChars, lineChars);
+        }
+    }
+
+    WGFXcmd *cmd = pushCmd(list, WGFX_CMD_TEXT_MONO, x, y, maxChars * font->width * scale, nLines * font->height * scale);
+    if(!cmd)
+    {
+        return 0;
+    }
+
+    cmd->color = fgColor;
+    cmd->params.text.string = string;
+    cmd->params.text.length = length;
+    cmd->params.text.font = font;
+    cmd->params.text.scale = scale;
+    cmd->params.text.bgColor = bgColor;
+    cmd->params.text.wrapMode = wrapMode;
+    return 1;
+}
+
+int wgfxCmdBitmap(WGFXcmdList *list, const WGFX_U8 *image, unsigned imgW, unsigned imgH,
+                  unsigned x, unsigned y, unsigned w, unsigned h, WGFXbitmapFlags flags)
+{
+    if(flags & WGFX_BITMAP_RLE)
+    {
+        // (would need to decode the whole image for every band)
+        return 0;
+    }
+
+    WGFXcmd *cmd = pushCmd(list, WGFX_CMD_BITMAP, x, y, MIN(w, imgW), MIN(h, imgH));
+    if(!cmd)
+    {
+        return 0;
+    }
+
+    cmd->color = 0;
+    cmd->params.bitmap.image = image;
+    cmd->params.bitmap.imgW = imgW;
+    cmd->params.bitmap.flags = flags;
+    return 1;
+}
+
+/// A horizontal band of the screen, being composited in the scratch buffer.
+typedef struct
+{
+    /// The band's pixel data (in the scratch buffer).
+    WGFX_U8 *data;
+
+    /// The rectangle of the screen covered by the band.
+    unsigned x, y, w, h;
+
+    /// Bytes per pixel; bytes per pixel row of `data`.
+    unsigned bpp, rowStride;
+} WGFXband;
+
+/// Intersects the `w * h` rectangle at `x`, `y` with the band.
+/// Returns false if they do not intersect; otherwise outputs the intersection's `[x0, x1) * [y0, y1)` (in screen coordinates).
+static int clipToBand(const WGFXband *band, unsigned x, unsigned y, unsigned w, unsigned h,
+                      unsigned *x0, unsigned *y0, unsigned *x1, unsigned *y1)
+{
+    *x0 = MAX(x, band->x);
+    *y0 = MAX(y, band->y);
+    *x1 = MIN(x + w, band->x + band->w);
+    *y1 = MIN(y + h, band->y + band->h);
+    return *x0 < *x1 && *y0 < *y1;
+}
+
+/// Returns a pointer to the pixel of the band's data at `x`, `y` (in screen coordinates).
+WGFX_FORCEINLINE static WGFX_U8 *bandPixel(const WGFXband *band, unsigned x, unsigned y)
+{
+    return band->data + (y - band->y) * band->rowStride + (x - band->x) * band->bpp;
+}
+
+static void compositeFillRect(const WGFXband *band, const WGFXcmd *cmd)
+{
+    unsigned x0, y0, x1, y1;
+    if(!clipToBand(band, cmd->x, cmd->y, cmd->w, cmd->h, &x0, &y0, &x1, &y1))
+    {
+        return;
+    }
+
+    WGFX_U8 *row = bandPixel(band, x0, y0);
+    for(unsigned y = y0; y < y1; y++)
+    {
+        fillPixels(row, (const WGFX_U8 *)cmd->color, band->bpp, x1 - x0);
+        row += band->rowStride;
+    }
+}
+
+static void compositeBitmap(const WGFXband *band, const WGFXcmd *cmd)
+{
+    unsigned x0, y0, x1, y1;
+    if(!clipToBand(band, cmd->x, cmd->y, cmd->w, cmd->h, &x0, &y0, &x1, &y1))
+    {
+        return;
+    }
+
+    const WGFX_SIZET imageRowStride = cmd->params.bitmap.imgW * band->bpp;
+    const WGFX_U8 *src = cmd->params.bitmap.image + (y0 - cmd->y) * imageRowStride + (x0 - cmd->x) * band->bpp;
+    const WGFX_SIZET rowSizeB = (x1 - x0) * band->bpp;
+    const int rodata = cmd->params.bitmap.flags & WGFX_BITMAP_RODATA;
+
+    WGFX_U8 *row = bandPixel(band, x0, y0);
+    for(unsigned y = y0; y < y1; y++)
+    {
+        if(rodata)
+        {
+            WGFX_RODATA_MEMCPY(row, src, rowSizeB);
+        }
+        else
+        {
+            WGFX_MEMCPY(row, src, rowSizeB);
+        }
+        row += band->rowStride;
+        src += imageRowStride;
+    }
+}
+
+/// Composites a text command to the band through `ctx`, that is shared by all text commands of a `wgfxDrawCmdList()`
+/// call (`font` null until the first one): only (re)initialized when the font, scale or colors of `cmd` differ from
+/// the ones `ctx` was last initialized for, not for each command in each band.
+static void compositeTextMono(WGFXscreen *self, const WGFXband *band, const WGFXcmd *cmd, WGFXmonoTextCtx *ctx)
+{
+    unsigned x0, y0, x1, y1;
+    if(!clipToBand(band, cmd->x, cmd->y, cmd->w, cmd->h, &x0, &y0, &x1, &y1))
+    {
+        return;
+    }
+
+    const WGFXcolor bgColor = cmd->params.text.bgColor;
+    if(ctx->font != cmd->params.text.font || ctx->scale != cmd->params.text.scale
+       || ctx->fgColor != (const WGFX_U8 *)cmd->color || ctx->bgColor != (const WGFX_U8 *)bgColor)
+    {
+        wgfxInitMonoTextCtx(ctx, self, cmd->params.text.font, cmd->params.text.scale, cmd->color, bgColor);
+    }
+
+    const char *const strEnd = cmd->params.text.string + cmd->params.text.length;
+    unsigned charX = cmd->x, charY = cmd->y;
+    for(const char *iCh = cmd->params.text.string; iCh < strEnd && charY < y1; iCh++)
+    {
+        if(*iCh == '\n' && (cmd->params.text.wrapMode & WGFX_WRAP_NEWLINE))
+        {
+            charX = cmd->x;
+            charY += ctx->charHeight;
+            continue;
+        }
+
+        unsigned cx0, cy0, cx1, cy1;
+        if(clipToBand(band, charX, charY, ctx->charWidth, ctx->charHeight, &cx0, &cy0, &cx1, &cy1))
+        {
+            wgfxCompositeMonoChar(ctx, monoGlyphData(ctx->font, (unsigned char)*iCh), bandPixel(band, cx0, cy0),
+                                  band->rowStride, cx0 - charX, cx1 - cx0, cy0 - charY, cy1 - cy0, !bgColor);
+            WGFX_STATS_ADD(self, glyphs, 1);
+        }
+        charX += ctx->charWidth;
+    }
+}
+
+/// Hashes `size` bytes of `data` (FNV-1a, a word at a time). Never returns 0, that is used for "unknown".
+static WGFX_U32 hashBand(const WGFX_U8 *data, WGFX_SIZET size)
+{
+    WGFX_U32 hash = 2166136261u;
+    WGFX_SIZET i = 0;
+    for(; i + 4 <= size; i += 4)
+    {
+        WGFX_U32 word;
+        WGFX_MEMCPY(&word, data + i, 4);
+        hash = (hash ^ word) * 16777619u;
+    }
+    for(; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+int wgfxDrawCmdList(WGFXscreen *self, WGFXcmdList *list, unsigned x, unsigned y, unsigned w, unsigned h,
+                    const WGFXcolor clearColor)
+{
+    const unsigned fullW = w, fullH = h;
+    unsigned dx, dy;
+    if(!clipRect(self, &x, &y, &w, &h, &dx, &dy))
+    {
+        return 1;
+    }
+    const int clipped = dx != 0 || dy != 0 || w != fullW || h != fullH;
+
+    const unsigned bandRows = scratchPixels(self) / w;
+    if(bandRows == 0)
+    {
+        // Not enough memory to fit even one row
+        return 0;
+    }
+
+    WGFXband band;
+    band.x = x;
+    band.w = w;
+    band.bpp = self->bpp;
+    band.rowStride = w * self->bpp;
+
+    // With dirty tracking, each band that changed is sent in its own address window.
+    // Bands of a clipped region do not match the ones that were hashed; forget the hashes, they would be stale after this
+    const int trackBands = list->bandHashes != 0 && !clipped;
+    if(list->bandHashes && clipped)
+    {
+        wgfxCmdListInvalidate(list);
+    }
+    if(!trackBands)
+    {
+        screenBeginWrite(self, x, y, w, h);
+    }
+
+    WGFXmonoTextCtx textCtx;
+    textCtx.font = 0;
+
+    unsigned iBand = 0;
+    for(band.y = y; band.y < y + h; band.y += band.h, iBand++)
+    {
+        band.h = MIN(bandRows, y + h - band.y);
+        band.data = acquireScratch(self);
+
+        fillPixels(band.data, (const WGFX_U8 *)clearColor, self->bpp, band.w * band.h);
+        for(unsigned i = 0; i < list->count; i++)
+        {
+            const WGFXcmd *cmd = &list->cmds[i];
+            switch(cmd->type)
+            {
+            case WGFX_CMD_FILL_RECT:
+                compositeFillRect(&band, cmd);
+                break;
+            case WGFX_CMD_TEXT_MONO:
+                compositeTextMono(self, &band, cmd, &textCtx);
+                break;
+            case WGFX_CMD_BITMAP:
+                compositeBitmap(&band, cmd);
+                break;
+            }
+        }
+
+        const WGFX_SIZET bandSizeB = band.h * band.rowStride;
+        if(!trackBands)
+        {
+            screenWrite(self, band.data, bandSizeB);
+            continue;
+        }
+
+        if(iBand < list->bandHashCount)
+        {
+            const WGFX_U32 hash = hashBand(band.data, bandSizeB);
+            if(hash == list->bandHashes[iBand])
+            {
+                continue; // Unchanged since the last time it was drawn; skip
+            }
+            list->bandHashes[iBand] = hash;
+        }
+        screenBeginWrite(self, band.x, band.y, band.w, band.h);
+        screenWrite(self, band.data, bandSizeB);
+        screenEndWrite(self);
+    }
+    if(!trackBands)
+    {
+        screenEndWrite(self);
+    }
+
+    return 1;
+}
@@ -0,0 +1,83 @@
+// weegfx_console.c - A hardware-scrolled text console for weegfx.
+// Copyright (c) 2019 Paolo Jovon <paolo.jovon@gmail.com>
+// Released under the 3-clause BSD license (see LICENSE)
+#include "weegfx.h"
+
+#include "weegfx/internal.h"
+
+/// Returns true if the console can scroll `screen` (see `WGFXscreen::scroll`).
+static int consoleCanScroll(const WGFXscreen *screen)
+{
+    return screen->scroll && screen->rotation == WGFX_ROTATE_0;
+}
+
+/// Returns the height in pixels of a line of the console.
+static unsigned consoleLineHeight(const WGFXconsole *console)
+{
+    return console->font->height * console->scale;
+}
+
+void wgfxConsoleInit(WGFXconsole *console, WGFXscreen *screen, unsigned y, unsigned lines, const WGFXmonoFont *font,
+                     unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor)
+{
+    console->screen = screen;
+    console->font = font;
+    console->scale = (scale > 1) ? scale : 1;
+    console->fgColor = fgColor;
+    console->bgColor = bgColor;
+    console->y = y;
+    console->lines = lines;
+    wgfxConsoleClear(console);
+}
+
+void wgfxConsoleClear(WGFXconsole *console)
+{
+    WGFXscreen *const self = console->screen;
+    const unsigned height = console->lines * consoleLineHeight(console);
+
+    console->first = 0;
+    console->count = 0;
+    if(consoleCanScroll(self) && height > 0)
+    {
+        screenScroll(self, console->y, height, console->y);
+    }
+    wgfxFillRect(self, 0, console->y, self->width, height, console->bgColor);
+}
+
+int wgfxConsolePutLine(WGFXconsole *console, const char *string, unsigned length)
+{
+    if(console->lines == 0)
+    {
+        return 1;
+    }
+
+    WGFXscreen *const self = console->screen;
+    const unsigned lineHeight = consoleLineHeight(console);
+
+    unsigned line;
+    if(console->count < console->lines)
+    {
+        line = console->count++;
+    }
+    else
+    {
+        // Full: recycle the oldest line (at the top), scrolling it to the bottom first so that it is overwritten
+        // where the new line is expected to appear
+        line = console->first;
+        console->first = (console->first + 1) % console->lines;
+        if(consoleCanScroll(self))
+        {
+            screenScroll(self, console->y, console->lines * lineHeight, console->y + console->first * lineHeight);
+        }
+    }
+
+    unsigned x = 0, y = console->y + line * lineHeight;
+    const int drawn = wgfxDrawTextMono(self, string, length, &x, &y, console->font, console->scale,
+                                       console->fgColor, console->bgColor, WGFX_WRAP_NONE);
+    if(x < self->width)
+    {
+        // Clear what is left of the previous contents of the line
+        wgfxFillRect(self, x, console->y + line * lineHeight, self->width - x, lineHeight, console->bgColor);
+    }
+    return drawn;
+}
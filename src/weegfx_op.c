@@ -0,0 +1,278 @@
+// weegfx_op.c - Resumable drawing operations for weegfx.
+// Copyright (c) 2019 Paolo Jovon <paolo.jovon@gmail.com>
+// Released under the 3-clause BSD license (see LICENSE)
+#include "weegfx.h"
+
+#include "weegfx/internal.h"
+#include "weegfx/kernels.h"
+
+/// Clips the `w * h` rectangle at `x`, `y` to the clip rectangle (or the screen) and stores it to `op`.
+/// Outputs how many columns/rows were cut off from its left/top to `*dx`, `*dy` (if not null).
+static void initOpArea(WGFXop *op, WGFXscreen *self, WGFXopType type, unsigned x, unsigned y, unsigned w, unsigned h,
+                       unsigned *dx, unsigned *dy)
+{
+    const int visible = clipRect(self, &x, &y, &w, &h, dx, dy);
+    op->type = visible ? type : WGFX_OP_DONE;
+    op->screen = self;
+    op->x = x;
+    op->y = y;
+    op->w = w;
+    op->h = h;
+    op->cursor = 0;
+}
+
+int wgfxBeginFillRect(WGFXop *op, WGFXscreen *self, unsigned x, unsigned y, unsigned w, unsigned h, const WGFXcolor color)
+{
+    initOpArea(op, self, WGFX_OP_FILL_RECT, x, y, w, h, 0, 0);
+    op->params.fill.color = color;
+    return 1;
+}
+
+int wgfxBeginBitmap(WGFXop *op, WGFXscreen *self, const WGFX_U8 *image, unsigned imgW, unsigned imgH,
+                    unsigned x, unsigned y, unsigned w, unsigned h, WGFXbitmapFlags flags)
+{
+    if(flags & WGFX_BITMAP_RLE)
+    {
+        op->type = WGFX_OP_DONE;
+        return 0;
+    }
+    unsigned dx, dy;
+    initOpArea(op, self, WGFX_OP_BITMAP, x, y, MIN(w, imgW), MIN(h, imgH), &dx, &dy);
+    op->params.bitmap.image = image + ((WGFX_SIZET)dy * imgW + dx) * self->bpp;
+    op->params.bitmap.imgW = imgW;
+    op->params.bitmap.flags = flags;
+    return 1;
+}
+
+/// Returns the end of the line of text starting at `iCh` (the next '\n', or `strEnd`).
+static const char *findLineEnd(const char *iCh, const char *strEnd)
+{
+    while(iCh < strEnd && *iCh != '\n')
+    {
+        iCh++;
+    }
+    return iCh;
+}
+
+int wgfxBeginTextMono(WGFXop *op, WGFXscreen *self, const char *string, unsigned length, unsigned x, unsigned y,
+                      const WGFXmonoFont *font, unsigned scale, const WGFXcolor fgColor, const WGFXcolor bgColor, WGFXwrapMode wrapMode)
+{
+    scale = (scale > 1) ? scale : 1;
+    op->type = WGFX_OP_DONE;
+    if(scratchPixels(self) < (WGFX_SIZET)font->width * scale * font->height * scale)
+    {
+        // Not enough memory to fit even one char
+        return 0;
+    }
+
+    length = (length == 0) ? stringLength(string) : length;
+    op->type = (length > 0) ? WGFX_OP_TEXT_MONO : WGFX_OP_DONE;
+    op->screen = self;
+    op->x = x;
+    op->y = y;
+    op->w = op->h = 0;
+    op->cursor = 0;
+    op->params.text.iCh = string;
+    op->params.text.strEnd = string + length;
+    op->params.text.lineEnd = findLineEnd(string, string + length);
+    op->params.text.font = font;
+    op->params.text.scale = scale;
+    op->params.text.fgColor = fgColor;
+    op->params.text.bgColor = bgColor;
+    op->params.text.wrapMode = wrapMode;
+    op->params.text.startX = x;
+    return 1;
+}
+
+static void stepFillRect(WGFXop *op)
+{
+    WGFXscreen *const self = op->screen;
+    const WGFX_SIZET total = (WGFX_SIZET)op->w * op->h;
+    const WGFX_U8 *const color = (const WGFX_U8 *)op->params.fill.color;
+
+    if(op->cursor == 0)
+    {
+        screenBeginWriteRotated(self, op->x, op->y, op->w, op->h); // (solid: in any pixel order)
+        if(screenWriteRepeat(self, color, total))
+        {
+            op->cursor = total;
+        }
+        else
+        {
+            // (the same pixels are sent over and over, so the start of the scratch buffer is only filled once,
+            // and reused by the next steps)
+            screenWaitWrite(self, self->scratchData);
+            fillPixels(self->scratchData, color, self->bpp, MIN(total, scratchPixels(self)));
+        }
+    }
+    if(op->cursor < total)
+    {
+        const WGFX_SIZET n = MIN(total - op->cursor, scratchPixels(self));
+        screenWrite(self, self->scratchData, n * self->bpp);
+        op->cursor += n;
+    }
+
+    if(op->cursor == total)
+    {
+        screenEndWrite(self);
+        op->type = WGFX_OP_DONE;
+    }
+}
+
+static void stepBitmap(WGFXop *op)
+{
+    WGFXscreen *const self = op->screen;
+    const unsigned bpp = self->bpp;
+    const WGFX_SIZET total = (WGFX_SIZET)op->w * op->h;
+    const WGFX_SIZET maxChunkPixels = scratchPixels(self);
+    const WGFX_U8 *const image = op->params.bitmap.image;
+    const unsigned imgW = op->params.bitmap.imgW;
+    const int rodata = op->params.bitmap.flags & WGFX_BITMAP_RODATA;
+
+    if(op->cursor == 0)
+    {
+        screenBeginWrite(self, op->x, op->y, op->w, op->h);
+    }
+
+    if(!rodata && op->w == imgW)
+    {
+        // Rows are contiguous: write directly from the image, a scratch buffer's worth of pixels at a time
+        const WGFX_SIZET n = MIN(total - op->cursor, maxChunkPixels);
+        screenWrite(self, image + op->cursor * bpp, n * bpp);
+        op->cursor += n;
+    }
+    else
+    {
+        // Copy rows (or parts of them) back-to-back into the scratch buffer until it is full
+        WGFX_U8 *const chunk = acquireScratch(self);
+        WGFX_SIZET chunkPixels = 0;
+        while(chunkPixels < maxChunkPixels && op->cursor < total)
+        {
+            const unsigned row = (unsigned)(op->cursor / op->w), col = (unsigned)(op->cursor % op->w);
+            const WGFX_SIZET n = MIN(op->w - col, maxChunkPixels - chunkPixels);
+            const WGFX_U8 *const src = image + ((WGFX_SIZET)row * imgW + col) * bpp;
+            if(rodata)
+            {
+                WGFX_RODATA_MEMCPY(chunk + chunkPixels * bpp, src, n * bpp);
+            }
+            else
+            {
+                WGFX_MEMCPY(chunk + chunkPixels * bpp, src, n * bpp);
+            }
+            chunkPixels += n;
+            op->cursor += n;
+        }
+        screenWrite(self, chunk, chunkPixels * bpp);
+    }
+
+    if(op->cursor == total)
+    {
+        screenEndWrite(self);
+        op->type = WGFX_OP_DONE;
+    }
+}
+
+static void stepTextMono(WGFXop *op)
+{
+    WGFXscreen *const self = op->screen;
+    const char *const strEnd = op->params.text.strEnd;
+    const WGFXwrapMode wrapMode = op->params.text.wrapMode;
+    const WGFXmonoFont *const font = op->params.text.font;
+    const unsigned scale = op->params.text.scale;
+    const unsigned charWidth = font->width * scale, charHeight = font->height * scale;
+    const unsigned chunkChars = (unsigned)(scratchPixels(self) / ((WGFX_SIZET)charWidth * charHeight));
+
+    // Move on (through newlines, wraps and offscreen text) until the next chunk to draw, then draw it
+    while(op->params.text.iCh < strEnd)
+    {
+#ifndef WGFX_NO_CLIPPING
+        if(op->y >= self->height)
+        {
+            // Line outside screen - done
+            break;
+        }
+        // (as `wgfxDrawTextMono()` does, wrap by the height of the visible part of a line clipped at the bottom)
+        const unsigned lineHeight = (op->y + charHeight >= self->height) ? self->height - op->y : charHeight;
+#else
+        const unsigned lineHeight = charHeight;
+#endif
+        const char *const iCh = op->params.text.iCh, *const lineEnd = op->params.text.lineEnd;
+        if(iCh == lineEnd)
+        {
+            // Skip the '\n' (moving to the next line only if wrapping on newlines, as `wgfxDrawTextMono()` does)
+            if(wrapMode & WGFX_WRAP_NEWLINE)
+            {
+                op->x = op->params.text.startX;
+                op->y += lineHeight;
+            }
+            op->params.text.iCh = iCh + 1;
+            op->params.text.lineEnd = findLineEnd(iCh + 1, strEnd);
+            continue;
+        }
+
+        unsigned nChars = (unsigned)MIN((WGFX_SIZET)(lineEnd - iCh), chunkChars);
+#ifndef WGFX_NO_CLIPPING
+        if(wrapMode & WGFX_WRAP_RIGHT)
+        {
+            // Only draw the characters that fit before the right edge, and wrap here: `wgfxDrawTextMono()` would wrap
+            // back to the start of the chunk instead of `startX`
+            const unsigned fitChars = (op->x < self->width) ? (self->width - op->x) / charWidth : 0;
+            if(fitChars == 0 && op->x > op->params.text.startX)
+            {
+                if(op->x < self->width && op->params.text.bgColor)
+                {
+                    // (blank what the next character would have partially covered, as `wgfxDrawTextMono()` does)
+                    wgfxFillRect(self, op->x, op->y, self->width - op->x, lineHeight, op->params.text.bgColor);
+                }
+                op->x = op->params.text.startX;
+                op->y += lineHeight;
+                continue;
+            }
+            nChars = (fitChars > 0) ? MIN(nChars, fitChars) : 1; // (not even one fits a line: as `wgfxDrawTextMono()` does)
+        }
+        else if(op->x >= self->width)
+        {
+            // The rest of this line is offscreen
+            op->params.text.iCh = lineEnd;
+            continue;
+        }
+#endif
+        wgfxDrawTextMono(self, iCh, nChars, &op->x, &op->y, font, scale, op->params.text.fgColor,
+                         op->params.text.bgColor, wrapMode);
+        op->params.text.iCh = iCh + nChars;
+        break;
+    }
+
+    if(op->params.text.iCh >= strEnd
+#ifndef WGFX_NO_CLIPPING
+       || op->y >= self->height
+#endif
+    )
+    {
+        op->type = WGFX_OP_DONE;
+    }
+}
+
+int wgfxStep(WGFXop *op, unsigned budget)
+{
+    budget = (budget > 0) ? budget : 1;
+    for(; budget > 0 && op->type != WGFX_OP_DONE; budget--)
+    {
+        switch(op->type)
+        {
+        case WGFX_OP_FILL_RECT:
+            stepFillRect(op);
+            break;
+        case WGFX_OP_BITMAP:
+            stepBitmap(op);
+            break;
+        case WGFX_OP_TEXT_MONO:
+            stepTextMono(op);
+            break;
+        default:
+            op->type = WGFX_OP_DONE;
+            break;
+        }
+    }
+    return op->type != WGFX_OP_DONE;
+}
@@ -0,0 +1,338 @@
+// weegfx_shapes.c - Line and shape primitives for weegfx, rasterized as horizontal spans.
+// Copyright (c) 2019 Paolo Jovon <paolo.jovon@gmail.com>
+// Released under the 3-clause BSD license (see LICENSE)
+#include "weegfx.h"
+
+#include "weegfx/internal.h"
+#include "weegfx/kernels.h"
+
+/// Collects the horizontal spans of a shape of one color, row by row from top to bottom, and fills them:
+/// consecutive rows that cover the same span are merged into a single address window.
+typedef struct
+{
+    WGFXscreen *self;
+    WGFXcolor color;
+    WGFXfillBatch batch;
+
+    /// The pending span, `[x0, x1) * [y, y + h)` (in screen coordinates, possibly offscreen); `h == 0` if none.
+    int x0, x1, y;
+    unsigned h;
+} WGFXspanWriter;
+
+static void initSpanWriter(WGFXspanWriter *sw, WGFXscreen *self, const WGFXcolor color)
+{
+    sw->self = self;
+    sw->color = color;
+    sw->batch.scratch = 0;
+    sw->h = 0;
+}
+
+/// Clips the `w * h` rectangle at `x`, `y` (that may be partly at negative coordinates) to the clip rectangle or
+/// the screen. Returns false if nothing is left of it; otherwise outputs the visible part to `*outX`, `*outY`, `*w`,
+/// `*h`, and how many columns/rows were cut off from its left/top to `*dx`, `*dy` (if not null).
+static int clipShapeRect(const WGFXscreen *self, int x, int y, unsigned *w, unsigned *h, unsigned *outX, unsigned *outY,
+                         unsigned *dx, unsigned *dy)
+{
+    const unsigned cutX = (x < 0) ? (unsigned)-x : 0, cutY = (y < 0) ? (unsigned)-y : 0;
+    if(cutX >= *w || cutY >= *h)
+    {
+        return 0;
+    }
+
+    *outX = (unsigned)(x + (int)cutX);
+    *outY = (unsigned)(y + (int)cutY);
+    *w -= cutX;
+    *h -= cutY;
+
+    unsigned clipDX, clipDY;
+    if(!clipRect(self, outX, outY, w, h, &clipDX, &clipDY))
+    {
+        return 0;
+    }
+    if(dx)
+    {
+        *dx = cutX + clipDX;
+    }
+    if(dy)
+    {
+        *dy = cutY + clipDY;
+    }
+    return 1;
+}
+
+/// Fills the pending span of `sw` (if any).
+static void flushSpan(WGFXspanWriter *sw)
+{
+    if(sw->h == 0 || sw->x1 <= sw->x0)
+    {
+        return;
+    }
+
+    unsigned x, y, w = (unsigned)(sw->x1 - sw->x0), h = sw->h;
+    if(clipShapeRect(sw->self, sw->x0, sw->y, &w, &h, &x, &y, 0, 0))
+    {
+        wgfxBatchFillRect(sw->self, &sw->batch, x, y, w, h, sw->color);
+    }
+    sw->h = 0;
+}
+
+/// Adds the `[x0, x1)` span on row `y` to `sw`, merging it with the pending one if it is the same span on the next row.
+static void addSpan(WGFXspanWriter *sw, int x0, int x1, int y)
+{
+    if(sw->h != 0 && x0 == sw->x0 && x1 == sw->x1 && y == sw->y + (int)sw->h)
+    {
+        sw->h++;
+        return;
+    }
+    flushSpan(sw);
+    sw->x0 = x0;
+    sw->x1 = x1;
+    sw->y = y;
+    sw->h = 1;
+}
+
+void wgfxDrawLine(WGFXscreen *self, unsigned x0, unsigned y0, unsigned x1, unsigned y1, const WGFXcolor color)
+{
+    if(y1 < y0)
+    {
+        // Always rasterize top to bottom, so that spans come in the order `addSpan()` can merge
+        unsigned tmp = x0;
+        x0 = x1;
+        x1 = tmp;
+        tmp = y0;
+        y0 = y1;
+        y1 = tmp;
+    }
+
+    WGFXspanWriter sw;
+    initSpanWriter(&sw, self, color);
+
+    // Bresenham, collecting all pixels of a row into one span
+    const int dx = (x1 > x0) ? (int)(x1 - x0) : (int)(x0 - x1), stepX = (x1 > x0) ? 1 : -1;
+    const int dy = (int)(y1 - y0);
+    int err = dx - dy;
+    int x = (int)x0, y = (int)y0, spanX0 = x, spanX1 = x;
+    for(;;)
+    {
+        if(x == (int)x1 && y == (int)y1)
+        {
+            break;
+        }
+
+        const int err2 = 2 * err;
+        if(err2 >= -dy)
+        {
+            err -= dy;
+            x += stepX;
+        }
+        if(err2 <= dx)
+        {
+            err += dx;
+            addSpan(&sw, MIN(spanX0, spanX1), MAX(spanX0, spanX1) + 1, y);
+            y++;
+            spanX0 = x;
+        }
+        spanX1 = x;
+    }
+    addSpan(&sw, MIN(spanX0, spanX1), MAX(spanX0, spanX1) + 1, y);
+    flushSpan(&sw);
+}
+
+/// Returns `floor(sqrt(n))`.
+static unsigned isqrt(WGFX_U32 n)
+{
+    WGFX_U32 root = 0, bit = 1ul << 30;
+    while(bit > n)
+    {
+        bit >>= 2;
+    }
+    while(bit != 0)
+    {
+        if(n >= root + bit)
+        {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (unsigned)root;
+}
+
+/// Returns how many pixels a disc of radius `r` extends left/right of its center on the row `dy` rows above/below it
+/// (i.e. the biggest `dx` so that `dx^2 + dy^2 <= r^2 + r`), or -1 if the row is outside of the disc.
+static int discHalfWidth(unsigned r, unsigned dy)
+{
+    const WGFX_U32 r2 = (WGFX_U32)r * r + r, dy2 = (WGFX_U32)dy * dy;
+    return (dy2 <= r2) ? (int)isqrt(r2 - dy2) : -1;
+}
+
+/// Returns the span that row `row` of a `w * h` rounded rectangle at `x` covers, as `[*x0, *x1)`.
+/// `r` must be `<= (MIN(w, h) - 1) / 2`.
+static void roundRectSpan(int x, unsigned w, unsigned h, unsigned r, unsigned row, int *x0, int *x1)
+{
+    unsigned dy = 0; // (distance from the row of the nearest corner's center, if in the top/bottom `r` rows)
+    if(row < r)
+    {
+        dy = r - row;
+    }
+    else if(row >= h - r)
+    {
+        dy = row - (h - 1 - r);
+    }
+    const int inset = (int)r - discHalfWidth(r, dy);
+    *x0 = x + inset;
+    *x1 = x + (int)w - inset;
+}
+
+/// Which spans of the rows of a rounded rectangle `fillRoundRectSpans()` fills.
+typedef enum
+{
+    ROUND_RECT_SHAPE, ///< The rounded rectangle itself
+    ROUND_RECT_LEFT,  ///< The part of its bounding box left of it
+    ROUND_RECT_RIGHT, ///< The part of its bounding box right of it
+} WGFXroundRectPart;
+
+/// Fills the `part` spans of all rows of a `w * h` rounded rectangle at `x`, `y` with `color`, as horizontal spans.
+static void fillRoundRectSpans(WGFXscreen *self, int x, int y, unsigned w, unsigned h, unsigned r,
+                               const WGFXcolor color, WGFXroundRectPart part)
+{
+    WGFXspanWriter sw;
+    initSpanWriter(&sw, self, color);
+    for(unsigned row = 0; row < h; row++)
+    {
+        int x0, x1;
+        roundRectSpan(x, w, h, r, row, &x0, &x1);
+        if(part == ROUND_RECT_LEFT)
+        {
+            x1 = x0;
+            x0 = x;
+        }
+        else if(part == ROUND_RECT_RIGHT)
+        {
+            x0 = x1;
+            x1 = x + (int)w;
+        }
+        if(x0 < x1)
+        {
+            addSpan(&sw, x0, x1, y + (int)row);
+        }
+    }
+    flushSpan(&sw);
+}
+
+/// Draws a `w * h` rounded rectangle at `x`, `y` filled with `color`, and fills the rest of its bounding box with
+/// `bgColor`: the box is rasterized into the scratch buffer band by band, and sent in a single address window.
+/// If the scratch buffer cannot fit one visible row of it, the shape and the background around it are filled as
+/// spans instead.
+static void fillRoundRectBanded(WGFXscreen *self, int x, int y, unsigned w, unsigned h, unsigned r,
+                                const WGFXcolor color, const WGFXcolor bgColor)
+{
+    unsigned visX, visY, visW = w, visH = h, dx, dy;
+    if(!clipShapeRect(self, x, y, &visW, &visH, &visX, &visY, &dx, &dy))
+    {
+        return;
+    }
+
+    const unsigned bandRows = (unsigned)MIN(scratchPixels(self) / visW, visH);
+    if(bandRows == 0)
+    {
+        // (one part at a time: the span writers' fill batches would overwrite each other's scratch buffer contents)
+        fillRoundRectSpans(self, x, y, w, h, r, color, ROUND_RECT_SHAPE);
+        fillRoundRectSpans(self, x, y, w, h, r, bgColor, ROUND_RECT_LEFT);
+        fillRoundRectSpans(self, x, y, w, h, r, bgColor, ROUND_RECT_RIGHT);
+        return;
+    }
+
+    const unsigned bpp = self->bpp;
+    screenBeginWrite(self, visX, visY, visW, visH);
+    for(unsigned bandY = 0; bandY < visH; bandY += bandRows)
+    {
+        const unsigned nRows = MIN(bandRows, visH - bandY);
+        WGFX_U8 *const band = acquireScratch(self);
+        WGFX_U8 *rowData = band;
+        for(unsigned i = 0; i < nRows; i++)
+        {
+            int x0, x1;
+            roundRectSpan(0, w, h, r, dy + bandY + i, &x0, &x1);
+
+            // (span relative to the visible part of the row)
+            const unsigned spanX0 = (unsigned)MAX(x0 - (int)dx, 0), spanX1 = (unsigned)MIN(MAX(x1 - (int)dx, 0), (int)visW);
+            if(spanX0 < spanX1)
+            {
+                fillPixels(rowData, (const WGFX_U8 *)bgColor, bpp, spanX0);
+                fillPixels(rowData + spanX0 * bpp, (const WGFX_U8 *)color, bpp, spanX1 - spanX0);
+                fillPixels(rowData + spanX1 * bpp, (const WGFX_U8 *)bgColor, bpp, visW - spanX1);
+            }
+            else
+            {
+                fillPixels(rowData, (const WGFX_U8 *)bgColor, bpp, visW);
+            }
+            rowData += visW * bpp;
+        }
+        screenWrite(self, band, (WGFX_SIZET)nRows * visW * bpp);
+    }
+    screenEndWrite(self);
+}
+
+/// Implements `wgfxFillRoundRect()` and `wgfxFillCircle()`, on a rectangle that may be partly at negative coordinates.
+static void fillRoundRect(WGFXscreen *self, int x, int y, unsigned w, unsigned h, unsigned r,
+                          const WGFXcolor color, const WGFXcolor bgColor)
+{
+    if(w == 0 || h == 0)
+    {
+        return;
+    }
+    r = MIN(r, (MIN(w, h) - 1) / 2);
+
+    if(bgColor)
+    {
+        fillRoundRectBanded(self, x, y, w, h, r, color, bgColor);
+    }
+    else
+    {
+        fillRoundRectSpans(self, x, y, w, h, r, color, ROUND_RECT_SHAPE);
+    }
+}
+
+void wgfxFillRoundRect(WGFXscreen *self, unsigned x, unsigned y, unsigned w, unsigned h, unsigned r,
+                       const WGFXcolor color, const WGFXcolor bgColor)
+{
+    fillRoundRect(self, (int)x, (int)y, w, h, r, color, bgColor);
+}
+
+void wgfxFillCircle(WGFXscreen *self, unsigned cx, unsigned cy, unsigned r, const WGFXcolor color, const WGFXcolor bgColor)
+{
+    fillRoundRect(self, (int)cx - (int)r, (int)cy - (int)r, 2 * r + 1, 2 * r + 1, r, color, bgColor);
+}
+
+void wgfxDrawCircle(WGFXscreen *self, unsigned cx, unsigned cy, unsigned r, const WGFXcolor color)
+{
+    // The outline is what is left of the filled disc once the rows above/below are removed from each row;
+    // the left and right arcs are collected separately, so that their vertical runs merge into tall spans
+    WGFXspanWriter left, right;
+    initSpanWriter(&left, self, color);
+    initSpanWriter(&right, self, color);
+
+    for(int dy = -(int)r; dy <= (int)r; dy++)
+    {
+        const unsigned absDY = (unsigned)((dy < 0) ? -dy : dy);
+        const int outer = discHalfWidth(r, absDY);
+        const int inner = MIN(discHalfWidth(r, absDY + 1) + 1, outer); // (at least one pixel per row)
+
+        const int y = (int)cy + dy;
+        if(inner == 0)
+        {
+            // (the arcs meet: one span for the whole row)
+            addSpan(&left, (int)cx - outer, (int)cx + outer + 1, y);
+            continue;
+        }
+        addSpan(&left, (int)cx - outer, (int)cx - inner + 1, y);
+        addSpan(&right, (int)cx + inner, (int)cx + outer + 1, y);
+    }
+    flushSpan(&left);
+    flushSpan(&right);
+}
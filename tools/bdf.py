@@ -188,6 +188,8 @@ class BdfFont:
         """Logical (PostScript) name of the font."""
         self.copyright = getval(properties, 'COPYRIGHT', None)
         """Copyright info on the font."""
+        self.pixel_bits = 1
+        """Bits per pixel of rendered characters (BDF fonts are always 1-bit)."""
 
         # Table for faster lookups
         self._chars = {child.items['ENCODING'][0]: child
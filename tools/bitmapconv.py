@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+# coding: utf-8
+"""
+weegfx/tools/bitmapconv.py: Converts images to C header files suitable for weegfx's `wgfxDrawBitmap()`.
+
+Copyright (c) 2019 Paolo Jovon <paolo.jovon@gmail.com>
+Released under the 3-clause BSD license (see LICENSE)
+"""
+
+import os
+import sys
+from argparse import ArgumentParser
+from typing import List, TextIO
+
+MAX_H_COL = 80
+"""Maximum column when generating the .h, after which to wrap."""
+
+RLE_MAX_PACKET = 128
+"""Maximum number of pixels in a `WGFX_BITMAP_RLE` packet."""
+
+
+def rgb565_be(r: int, g: int, b: int) -> bytes:
+    value = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+    return bytes([value >> 8, value & 0xFF])
+
+
+def rgb565_le(r: int, g: int, b: int) -> bytes:
+    return rgb565_be(r, g, b)[::-1]
+
+
+PIXEL_FORMATS = {
+    'rgb565': rgb565_be,
+    'rgb565le': rgb565_le,
+    'rgb888': lambda r, g, b: bytes([r, g, b]),
+    'bgr888': lambda r, g, b: bytes([b, g, r]),
+    'gray8': lambda r, g, b: bytes([(r * 77 + g * 150 + b * 29) >> 8]),
+}
+"""Maps pixel format names to a callable that converts a R,G,B triplet to the pixel's bytes (as sent to the screen)."""
+
+
+def rle_encode(pixels: List[bytes]) -> bytes:
+    """Encodes a sequence of pixels (each a `bytes` of `bpp` bytes) to `WGFX_BITMAP_RLE` packets."""
+
+    out = bytearray()
+    literal = []
+
+    def flush_literal():
+        while literal:
+            packet = literal[:RLE_MAX_PACKET]
+            del literal[:RLE_MAX_PACKET]
+            out.append(len(packet) - 1)
+            for pixel in packet:
+                out.extend(pixel)
+
+    i = 0
+    while i < len(pixels):
+        run = 1
+        while i + run < len(pixels) and run < RLE_MAX_PACKET and pixels[i + run] == pixels[i]:
+            run += 1
+
+        # (runs of 2 pixels are only worth it for pixels bigger than the one byte of an extra header)
+        if run >= 3 or (run == 2 and len(pixels[i]) > 1):
+            flush_literal()
+            out.append(0x80 | (run - 1))
+            out.extend(pixels[i])
+        else:
+            literal += pixels[i:i + run]
+        i += run
+    flush_literal()
+    return bytes(out)
+
+
+def emit_bitmap_header(name: str, width: int, height: int, pixels: List[bytes], rle: bool, stream: TextIO):
+    """Outputs a weegfx C header file storing the given `width * height` image (raw or `WGFX_BITMAP_RLE`)."""
+
+    def hexbyte(byte):
+        return f'0x{byte:02X}'
+
+    varname = ''.join(ch if ch.isalnum() else '_' for ch in name.upper())
+    h_guard = f'BITMAP_{varname}_H'
+
+    raw_size = sum(len(pixel) for pixel in pixels)
+    data = rle_encode(pixels) if rle else b''.join(pixels)
+    flags = 'WGFX_BITMAP_RODATA | WGFX_BITMAP_RLE' if rle else 'WGFX_BITMAP_RODATA'
+
+    print(f"""// Autogenerated by weegfx/tools/bitmapconv.py
+// Only include this file ONCE in the codebase (every translation unit gets its copy of the bitmap data!)
+//
+// Bitmap: {name} {width}x{height}, {len(data)} bytes{f" (RLE; {raw_size} bytes raw)" * rle}
+// Draw with: wgfxDrawBitmap(screen, {varname}_DATA, {varname}_W, {varname}_H, x, y, w, h, {varname}_FLAGS)
+#ifndef {h_guard}
+#define {h_guard}
+
+#define {varname}_W {width}
+#define {varname}_H {height}
+#define {varname}_FLAGS ({flags})
+
+static const WGFX_U8 {varname}_DATA[{len(data)}] WGFX_RODATA = {{""", end='', file=stream)
+
+    h_col = MAX_H_COL
+    for byte in data:
+        byte_str = hexbyte(byte) + ', '
+        h_col += len(byte_str)
+        if h_col >= MAX_H_COL:
+            print('\n    ', file=stream, end='')
+            h_col = len(byte_str)
+        print(byte_str, end='', file=stream)
+
+    print(f"""
+}};
+
+#endif // {h_guard}""", file=stream)
+
+
+if __name__ == '__main__':
+    argp = ArgumentParser(
+        description="Converts an image to a C header suitable for weegfx")
+    argp.add_argument('-o', '--outfile', type=str, required=False,
+                      help="The file to output to (optional; defaults to stdout)")
+    argp.add_argument('-f', '--format', type=str, choices=PIXEL_FORMATS.keys(), default='rgb565',
+                      help="The pixel format of the screen (default: rgb565, big-endian)")
+    argp.add_argument('-r', '--rle', action='store_true',
+                      help="Run-length encode the image (WGFX_BITMAP_RLE)")
+    argp.add_argument('-n', '--name', type=str, required=False,
+                      help="The name of the bitmap in the header (optional; defaults to the image's filename)")
+    argp.add_argument('infile', type=str,
+                      help='The image file to convert (any format read by Pillow)')
+
+    args = argp.parse_args()
+
+    if not os.path.isfile(args.infile):
+        raise RuntimeError(f"Invalid image file: {args.infile}")
+
+    try:
+        from PIL import Image
+    except ImportError:
+        raise RuntimeError("Install `Pillow` to load images!")
+
+    image = Image.open(args.infile).convert('RGB')
+    to_pixel = PIXEL_FORMATS[args.format]
+    pixels = [to_pixel(*rgb) for rgb in image.getdata()]
+    name = args.name or os.path.splitext(os.path.basename(args.infile))[0]
+
+    outfile = open(args.outfile, 'w') if args.outfile else sys.stdout
+    with outfile:
+        emit_bitmap_header(name, image.width, image.height, pixels, args.rle, outfile)
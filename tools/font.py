@@ -15,3 +15,42 @@ def row_width(width: int) -> int:
 
 BBox = namedtuple('BBox', 'w h ox oy')
 """The bounding box of a font's characters (width / height / origin X / origin Y)."""
+
+
+def pack_bitmap(bitmap: list, width: int, height: int) -> list:
+    """Repacks a character bitmap with rows of `row_width(width)` bits so that rows are contiguous (no padding bits
+    between them); the result is padded to a whole number of bytes at the end. See `WGFX_FONT_PACKED`.
+    (For anti-aliased bitmaps, pass `width * pixel_bits`: rows are stored as if they were that many pixels wide)."""
+    row_bytes = row_width(width) // 8
+    bits = []
+    for row in range(height):
+        for col in range(width):
+            byte = bitmap[row * row_bytes + col // 8]
+            bits.append((byte >> (7 - col % 8)) & 1)
+    bits += [0] * (-len(bits) % 8)
+    return [sum(bit << (7 - i) for i, bit in enumerate(bits[start:start + 8])) for start in range(0, len(bits), 8)]
+
+
+def rotate_bitmap(bitmap: list, width: int, height: int, degrees: int, pixel_bits: int = 1) -> list:
+    """Rotates a character bitmap with rows of `row_width(width * pixel_bits)` bits clockwise by `degrees` (0, 90, 180
+    or 270). The result has rows of `row_width()` of its own width, that is `height` for 90 and 270 degrees.
+    See `WGFX_FONT_ROTATED_90` & co. (and `WGFX_FONT_AA2` for `pixel_bits`)."""
+    row_bytes = row_width(width * pixel_bits) // 8
+    out_w, out_h = (height, width) if degrees in (90, 270) else (width, height)
+    out_row_bytes = row_width(out_w * pixel_bits) // 8
+    pixel_mask = (1 << pixel_bits) - 1
+    out = [0x00] * (out_row_bytes * out_h)
+    for row in range(out_h):
+        for col in range(out_w):
+            if degrees == 90:
+                src_col, src_row = row, height - 1 - col
+            elif degrees == 180:
+                src_col, src_row = width - 1 - col, height - 1 - row
+            elif degrees == 270:
+                src_col, src_row = width - 1 - row, col
+            else:
+                src_col, src_row = col, row
+            src_bit, out_bit = src_col * pixel_bits, col * pixel_bits
+            value = (bitmap[src_row * row_bytes + src_bit // 8] >> (8 - pixel_bits - src_bit % 8)) & pixel_mask
+            out[row * out_row_bytes + out_bit // 8] |= value << (8 - pixel_bits - out_bit % 8)
+    return out
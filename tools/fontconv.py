@@ -9,11 +9,12 @@ Released under the 3-clause BSD license (see LICENSE)
 
 import os
 import sys
+import warnings
 from argparse import ArgumentParser
-from typing import TextIO
+from typing import List, TextIO, Tuple
 
 import bdf
-from font import row_width
+from font import row_width, pack_bitmap, rotate_bitmap
 
 
 def bdf_maker(args) -> 'Font':
@@ -22,6 +23,8 @@ def bdf_maker(args) -> 'Font':
     with open(args.infile, 'r') as infile:
         record = bdf.BdfRecord.parse_from(infile, 'FONT')
 
+    if args.aa:
+        raise ValueError('Anti-aliased fonts (--aa) are only supported for vector fonts')
     if args.width and record.bbox.w != width:
         raise ValueError(f'Expected a font of width {width}px, but loaded one of width {record.bbox.w}px')
     return bdf.BdfFont(record)
@@ -34,20 +37,33 @@ FONT_MAKERS = {
 
 try:
     from ftfont import FTFont
-    ftfont_maker = lambda args: FTFont(args.infile, width=args.width, dpi=args.dpi)
+    ftfont_maker = lambda args: FTFont(args.infile, width=args.width, dpi=args.dpi, pixel_bits=args.aa or 1)
     FONT_MAKERS['.ttf'] = ftfont_maker
     FONT_MAKERS['.otf'] = ftfont_maker
 except ImportError:
-    raise RuntimeWarning("Install `freetype-py` and `numpy` for OTF and TTF font support!")
+    warnings.warn("Install `freetype-py` and `numpy` for OTF and TTF font support!", RuntimeWarning)
 
 
 MAX_H_COL = 80
 """Maximum column when generating the .h, after which to wrap."""
 
+MAX_CODEPOINT = 0x10FFFF
+"""The maximum Unicode codepoint."""
 
-def emit_mono_font_header(font: 'Font', first_ch: int, last_ch: int, stream: TextIO):
+
+def emit_mono_font_header(font: 'Font', first_ch: int, last_ch: int, stream: TextIO, packed: bool = False,
+                          sparse: bool = False, extra_ranges: List[Tuple[int, int]] = (), cpp: bool = False,
+                          rotate: int = 0):
     """Outputs a weegfx C header file storing a character range (`start_ch`..`end_ch`, both inclusive)
-    of given font to `stream`. Only accepts monospace fonts!"""
+    of given font to `stream`. Only accepts monospace fonts!
+    If `packed`, outputs a `WGFX_FONT_PACKED` font (rows of pixels not padded to whole bytes).
+    If `sparse`, outputs a font with a table of codepoint ranges instead: it stores only the characters in
+    `first_ch..last_ch` and `extra_ranges` (that can go beyond 255) that are present in the font.
+    If `cpp`, also outputs a `wgfx::MonoFont` descriptor for weegfx.hpp (only for dense, unpacked, unrotated fonts).
+    If `rotate` (90, 180 or 270), stores glyphs pre-rotated clockwise by that much (a `WGFX_FONT_ROTATED_*` font), for
+    screens with the same `WGFXscreen::rotation`.
+    Fonts that render characters with 2 or 4 bits of coverage per pixel (`font.pixel_bits`) are output as anti-aliased
+    `WGFX_FONT_AA2`/`WGFX_FONT_AA4` fonts."""
 
     def normname(name):
         return ''.join(ch if ch.isalnum() else '_' for ch in name)
@@ -55,43 +71,80 @@ def emit_mono_font_header(font: 'Font', first_ch: int, last_ch: int, stream: Tex
     def hexbyte(byte):
         return f'0x{byte:02X}'
 
+    def hexcp(cp):
+        return f'0x{cp:04X}'
+
     if first_ch > last_ch:
-        first_ch, last_ch = first_ch, last_ch
-    if not (0 <= first_ch <= 255) or not (0 <= last_ch <= 255):
-        raise ValueError(
-            'Invalid character range (note: non-ASCII chars are not yet supported!)')
+        first_ch, last_ch = last_ch, first_ch
+    pixel_bits = font.pixel_bits
+    if cpp and (packed or sparse or rotate or pixel_bits != 1):
+        raise ValueError('C++ font descriptors (--cpp) are only supported for dense, unpacked, unrotated, 1-bit fonts')
+    if rotate not in (0, 90, 180, 270):
+        raise ValueError('Invalid rotation (must be 0, 90, 180 or 270 degrees)')
+    if sparse:
+        char_ranges = [(first_ch, last_ch)] + [(min(r), max(r)) for r in extra_ranges]
+        if any(not (0 <= first <= last <= MAX_CODEPOINT) for first, last in char_ranges):
+            raise ValueError('Invalid character range')
+    else:
+        if extra_ranges:
+            raise ValueError('Multiple character ranges are only supported by sparse fonts (see --sparse)')
+        if not (0 <= first_ch <= 255) or not (0 <= last_ch <= 255):
+            raise ValueError(
+                'Invalid character range (note: use --sparse for non-ASCII chars!)')
+        char_ranges = [(first_ch, last_ch)]
 
     h_varname = f'FONT_{normname(font.family.upper())}_{normname(font.weight.upper())}_{font.bbox.w}_{font.bbox.h}'
     h_guard = h_varname + '_H'
 
-    h_data_size = row_width(font.bbox.w) // 8 * font.bbox.h * (last_ch - first_ch + 1)
+    # Pick the characters to store: all of the range for dense fonts (zero-filling missing ones),
+    # only the present ones for sparse fonts
+    empty_char_bitmap = [0x00] * (row_width(font.bbox.w * pixel_bits) // 8 * font.bbox.h)
+    chars = []
+    for ich in sorted(set(ich for first, last in char_ranges for ich in range(first, last + 1))):
+        char_bitmap = font.render_char(ich)
+        if char_bitmap is None:
+            if sparse:
+                continue
+            print(f'Character {ich} missing, zero-filling pixel data',
+                  file=sys.stderr)
+            char_bitmap = empty_char_bitmap
+        chars.append((ich, char_bitmap))
+
+    # (the size of characters as stored: rotated by 90/270 degrees, they are `h * w`; anti-aliased, their rows are as
+    # long as the ones of a `pixel_bits` times wider 1-bit font)
+    stored_w, stored_h = (font.bbox.h, font.bbox.w) if rotate in (90, 270) else (font.bbox.w, font.bbox.h)
+    row_bits = stored_w * pixel_bits
+    if packed:
+        char_size = -((-row_bits * stored_h) // 8)
+        char_size_str = f'// = ceil({row_bits} * {stored_h} / 8)'
+    else:
+        char_size = row_width(row_bits) // 8 * stored_h
+        char_size_str = f'// = {row_width(row_bits) // 8} * {stored_h}'
+    h_data_size = char_size * len(chars)
+    ranges_str = ', '.join(f'{hexcp(first)}..{hexcp(last)}' for first, last in char_ranges)
     h_start = f"""// Autogenerated by weegfx/tools/fontconv.py
 // Only include this file ONCE in the codebase (every translation unit gets its copy of the font data!)
 //
 // Font: {font.family or '<unknown family>'} {font.bbox.w}x{font.bbox.h} {font.weight or ''}
 //       {font.logical_name or '<unknown logical name>'}
 //       {font.copyright or '<no copyright info>'}
-// Character range: {hexbyte(first_ch)}..{hexbyte(last_ch)} (both inclusive)
+// Character range: {ranges_str} (both inclusive){" - packed" * packed}{" - sparse" * sparse}{f" - rotated {rotate}" * bool(rotate)}{f" - anti-aliased {pixel_bits}-bit" * (pixel_bits != 1)}
 #ifndef {h_guard}
 #define {h_guard}
 
 static const WGFX_U8 {h_varname}_DATA[{h_data_size}] WGFX_RODATA = {{"""
     print(h_start, file=stream)
 
-    empty_char_bitmap = [0x00] * (row_width(font.bbox.w) // 8 * font.bbox.h)
-
-    for ich in range(first_ch, last_ch + 1):
-        char_bitmap = font.render_char(ich)
-        if char_bitmap is None:
-            print(f'Character {ich} missing, zero-filling pixel data',
-                  file=sys.stderr)
-            char_bitmap = empty_char_bitmap
+    for ich, char_bitmap in chars:
+        char_bitmap_data = rotate_bitmap(char_bitmap, font.bbox.w, font.bbox.h, rotate, pixel_bits) if rotate else char_bitmap
+        if packed:
+            char_bitmap_data = pack_bitmap(char_bitmap_data, row_bits, stored_h)
 
         print(
-            f'    // {hexbyte(ich)} {repr(chr(ich))}{" (MISSING)" * (char_bitmap is empty_char_bitmap)}', end='', file=stream)
+            f'    // {hexcp(ich) if sparse else hexbyte(ich)} {repr(chr(ich))}{" (MISSING)" * (char_bitmap is empty_char_bitmap)}', end='', file=stream)
 
         h_col = MAX_H_COL
-        for byte in char_bitmap:
+        for byte in char_bitmap_data:
             byte_str = hexbyte(byte) + ', '
             h_col += len(byte_str)
             if h_col >= MAX_H_COL:
@@ -101,14 +154,53 @@ static const WGFX_U8 {h_varname}_DATA[{h_data_size}] WGFX_RODATA = {{"""
 
         print('', file=stream)
 
-    h_end = f"""}};
-
+    print('};', file=stream)
+
+    if sparse:
+        # Group consecutive codepoints into ranges: (first codepoint, count, first glyph index)
+        glyph_ranges = []
+        for iglyph, (ich, _) in enumerate(chars):
+            if glyph_ranges and glyph_ranges[-1][0] + glyph_ranges[-1][1] == ich and glyph_ranges[-1][1] < 0xFFFF:
+                glyph_ranges[-1][1] += 1
+            else:
+                glyph_ranges.append([ich, 1, iglyph])
+        if len(chars) > 0xFFFF:
+            raise ValueError('Too many characters for a sparse font (at most 65535 are supported)')
+
+        print(f"""
+static const WGFXglyphRange {h_varname}_RANGES[{len(glyph_ranges)}] WGFX_RODATA = {{""", file=stream)
+        for first, count, first_glyph in glyph_ranges:
+            print(f'    {{{hexcp(first)}, {count}, {first_glyph}}},', file=stream)
+        print('};', file=stream)
+
+    flags = (['WGFX_FONT_PACKED'] if packed else []) + ([f'WGFX_FONT_ROTATED_{rotate}'] if rotate else []) \
+        + ([f'WGFX_FONT_AA{pixel_bits}'] if pixel_bits != 1 else [])
+    if not flags:
+        flags_str = '(WGFXmonoFontFlags)0'
+    elif len(flags) == 1:
+        flags_str = flags[0]
+    else:
+        flags_str = f'(WGFXmonoFontFlags)({" | ".join(flags)})'
+    h_end = f"""
 static const WGFXmonoFont {h_varname} WGFX_RODATA = {{
     {font.bbox.w}, {font.bbox.h},
-    {hexbyte(first_ch)}, {hexbyte(last_ch)},
+    {"0, 0, // (sparse)" if sparse else f"{hexbyte(first_ch)}, {hexbyte(last_ch)},"}
     {h_varname}_DATA,
-    {row_width(font.bbox.w) // 8 * font.bbox.h}, // = {row_width(font.bbox.w) // 8} * {font.bbox.h}
-}};
+    {char_size}, {char_size_str}
+    {flags_str},"""
+    if sparse:
+        h_end += f"""
+    {h_varname}_RANGES, {len(glyph_ranges)},"""
+    h_end += f"""
+}};"""
+    if cpp:
+        h_end += f"""
+
+#ifdef __cplusplus
+// (for weegfx.hpp: the same font, with its layout known at compile time)
+static constexpr wgfx::MonoFont<{font.bbox.w}, {font.bbox.h}, {hexbyte(first_ch)}, {hexbyte(last_ch)}> {h_varname}_CPP = {{{h_varname}_DATA}};
+#endif"""
+    h_end += f"""
 
 #endif // {h_guard}"""
     print(h_end, file=stream)
@@ -123,6 +215,18 @@ if __name__ == '__main__':
                       help="The size in pixels of the font to render (mandatory for vector fonts; ignored for bitmap fonts)")
     argp.add_argument('-D', '--dpi', type=int, required=False, default=300,
                       help="Target dots-per-inch when rendering the font (ignored for non-vector fonts)")
+    argp.add_argument('-p', '--packed', action='store_true',
+                      help="Output a packed font (rows not padded to whole bytes; smaller, but needs weegfx's WGFX_FONT_PACKED support)")
+    argp.add_argument('-s', '--sparse', action='store_true',
+                      help="Output a sparse font (only present characters, with a table of codepoint ranges; supports codepoints beyond 255)")
+    argp.add_argument('-c', '--cpp', action='store_true',
+                      help="Also output a wgfx::MonoFont descriptor, for use with weegfx.hpp (dense, unpacked fonts only)")
+    argp.add_argument('-R', '--rotate', type=int, choices=(0, 90, 180, 270), default=0,
+                      help="Store glyphs pre-rotated clockwise by this many degrees, for screens with the same WGFXscreen::rotation (text then renders as fast as unrotated)")
+    argp.add_argument('-a', '--aa', type=int, choices=(2, 4), required=False,
+                      help="Output an anti-aliased font, with this many bits of coverage per pixel (vector fonts only)")
+    argp.add_argument('-r', '--range', type=int, nargs=2, action='append', default=[], metavar=('FIRSTCH', 'LASTCH'),
+                      help="An additional range of characters to output (inclusive; only for sparse fonts, can be repeated)")
     argp.add_argument('infile', type=str,
                       help='The font file to convert')
     argp.add_argument('firstch', type=int,
@@ -144,4 +248,6 @@ if __name__ == '__main__':
     outfile = open(args.outfile, 'w') if args.outfile else sys.stdout
     with outfile:
         font = font_maker(args)
-        emit_mono_font_header(font, args.firstch, args.lastch, outfile)
+        emit_mono_font_header(font, args.firstch, args.lastch, outfile, packed=args.packed,
+                              sparse=args.sparse, extra_ranges=args.range, cpp=args.cpp,
+                              rotate=args.rotate)
@@ -35,8 +35,12 @@ class FTFont:
         return (glyph_width, line_height)
         
 
-    def __init__(self, path: str, width: int, dpi: int):
-        """Loads the font given its filepath, height (in pixels) and target DPI (for hinting)."""
+    def __init__(self, path: str, width: int, dpi: int, pixel_bits: int = 1):
+        """Loads the font given its filepath, height (in pixels) and target DPI (for hinting).
+        `pixel_bits` is 1 to render characters monochrome, or 2/4 to render them anti-aliased (see `render_char()`)."""
+
+        if pixel_bits not in (1, 2, 4):
+            raise ValueError('Invalid bits per pixel (must be 1, 2 or 4)')
 
         self._font = ft.Face(path)
         if not self._font.is_fixed_width:
@@ -59,22 +63,31 @@ class FTFont:
         """Logical (PostScript) name of the font."""
         self.copyright = None
         """Copyright info on the font."""
+        self.pixel_bits = pixel_bits
+        """Bits per pixel of rendered characters: 1, or 2/4 bits of coverage (see `WGFX_FONT_AA2`)."""
 
 
     def render_char(self, code: int) -> List[int]:
         """Renders the character with the given code to a list of bytes.
-        (`n` bytes per row, left-to-right, top-to-bottom).
+        (`n` bytes per row, left-to-right, top-to-bottom; `pixel_bits` bits per pixel, MSB first).
 
         Returns `None` if the character is missing from the font."""
 
-        self._font.load_char(code, ft.FT_LOAD_RENDER | ft.FT_LOAD_TARGET_MONO)  #< !!
+        mono = self.pixel_bits == 1
+        self._font.load_char(code, ft.FT_LOAD_RENDER | (ft.FT_LOAD_TARGET_MONO if mono else ft.FT_LOAD_TARGET_NORMAL))  #< !!
         # FIXME: Return None if glyph could not be loaded properly
         glyph = self._font.glyph
 
         #assert glyph.metrics.horiAdvance // 64 == self.bbox.h
         glyph_bmp_bytes = np.array(glyph.bitmap.buffer, dtype=np.uint8).reshape((glyph.bitmap.rows, glyph.bitmap.pitch))
-        glyph_bmp = np.unpackbits(glyph_bmp_bytes, axis=1)
-        out_bmp = np.zeros((self.bbox.h, row_width(self.bbox.w)), dtype=np.uint8)
+        if mono:
+            glyph_bmp = np.unpackbits(glyph_bmp_bytes, axis=1)
+            out_bmp = np.zeros((self.bbox.h, row_width(self.bbox.w)), dtype=np.uint8)
+        else:
+            # Quantize the 8-bit coverage that FreeType renders to `pixel_bits`
+            max_value = (1 << self.pixel_bits) - 1
+            glyph_bmp = ((glyph_bmp_bytes.astype(np.uint32) * max_value + 127) // 255).astype(np.uint8)
+            out_bmp = np.zeros((self.bbox.h, self.bbox.w), dtype=np.uint8)
 
         sy = self.bbox.h + self.bbox.oy - glyph.bitmap_top  # quad bottom -> baseline -> glyph top
         ey = sy + glyph.bitmap.rows
@@ -92,4 +105,10 @@ class FTFont:
 
         out_bmp[sy:ey, sx:ex] = glyph_bmp[:(ey - sy), :(ex - sx)]
 
+        if not mono:
+            # Each pixel's value to `pixel_bits` bits (MSB first), then rows padded to whole bytes
+            out_bits = np.unpackbits(out_bmp[:, :, np.newaxis], axis=2)[:, :, 8 - self.pixel_bits:]
+            out_bits = out_bits.reshape((self.bbox.h, self.bbox.w * self.pixel_bits))
+            row_bits = self.bbox.w * self.pixel_bits
+            out_bmp = np.pad(out_bits, ((0, 0), (0, row_width(row_bits) - row_bits)))
         return np.packbits(out_bmp.ravel())